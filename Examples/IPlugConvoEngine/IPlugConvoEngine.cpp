@@ -3,43 +3,31 @@
 
 IPlugConvoEngine::IPlugConvoEngine(const InstanceInfo& info)
 : iplug::Plugin(info, MakeConfig(kNumParams, kNumPresets))
+#if IPLUG_DSP
+, mConvolver(1, 1024, [this](const WDL_FFT_REAL* pSrc, int srcLength, double srcRate, WDL_FFT_REAL* pDst, int dstLength, double dstRate) {
+    PrepareResampler(srcRate, dstRate);
+    Resample(pSrc, srcLength, srcRate, pDst, dstLength, dstRate);
+  }, kResamplerID) // Names the resampler, so that instances share the resampled IR
+#endif
 {
   GetParam(kParamDry)->InitDouble("Dry", 0., 0., 1., 0.001);
   GetParam(kParamWet)->InitDouble("Wet", 1., 0., 1., 0.001);
+
+#if IPLUG_DSP
+  // The IR is resampled when the sample rate is known, see OnReset()
+  const float* pIR = mIR;
+  mConvolver.SetImpulse(&pIR, 1, sizeof(mIR) / sizeof(mIR[0]), 44100.);
+#endif
 }
 
 #if IPLUG_DSP
 void IPlugConvoEngine::ProcessBlock(sample** inputs, sample** outputs, int nFrames)
 {
-  sample* inputL = inputs[0];
-  sample* outputL = outputs[0];
-  
-  mEngine.Add(inputs, nFrames, 1);
-
-  int nAvailableSamples = std::min(mEngine.Avail(nFrames), nFrames);
-
   const sample dryGain = GetParam(kParamDry)->Value();
   const sample wetGain = GetParam(kParamWet)->Value();
 
-  // If not enough samples are available yet, then only output the dry signal
-  for (auto i = 0; i < nFrames - nAvailableSamples; ++i)
-  {
-    *outputL++ = dryGain * *inputL++;
-  }
-
-  // Output samples from the convolution engine
-  if (nAvailableSamples > 0)
-  {
-    // Apply the dry/wet mix
-    WDL_FFT_REAL* pWetSignal = mEngine.Get()[0];
-    for (auto i = 0; i < nAvailableSamples; ++i)
-    {
-      *outputL++ = dryGain * *inputL++ + wetGain * *pWetSignal++;
-    }
-
-    // Remove the sample block from the convolution engine's buffer
-    mEngine.Advance(nAvailableSamples);
-  }
+  // Until the IR is ready, and for the latency after that, only the dry signal is output
+  mConvolver.ProcessBlock(inputs, outputs, nFrames, dryGain, wetGain);
 }
 
 void IPlugConvoEngine::OnReset()
@@ -48,29 +36,21 @@ void IPlugConvoEngine::OnReset()
   {
     mSampleRate = GetSampleRate();
 
-    static constexpr int irLength = sizeof(mIR) / sizeof(mIR[0]);
-    static constexpr double irSampleRate = 44100.;
-    mImpulse.SetNumChannels(1);
+    // The IR is resampled and partitioned on a worker thread, the previous one keeps playing until it is ready, then they are crossfaded
+    mConvolver.SetSampleRate(mSampleRate);
+  }
+
+  SetLatency(mConvolver.GetLatency());
+}
 
+void IPlugConvoEngine::PrepareResampler(double srcRate, double destRate)
+{
 #if defined USE_WDL_RESAMPLER
-    mResampler.SetMode(false, 0, true); // Sinc, default size
-    mResampler.SetFeedMode(true); // Input driven
+  mResampler.SetMode(false, 0, true); // Sinc, default size
+  mResampler.SetFeedMode(true); // Input driven
 #elif defined USE_R8BRAIN
-    mResampler = std::make_unique<CDSPResampler16IR>(irSampleRate, mSampleRate, mBlockLength);
+  mResampler = std::make_unique<CDSPResampler16IR>(srcRate, destRate, mBlockLength);
 #endif
-
-    // Resample the impulse response.
-    auto len = mImpulse.SetLength(ResampleLength(irLength, irSampleRate, mSampleRate));
-    if (len)
-    {
-      Resample(mIR, irLength, irSampleRate, mImpulse.impulses[0].Get(), len, mSampleRate);
-    }
-    
-    // Tie the impulse response to the convolution engine.
-    mEngine.SetImpulse(&mImpulse);
-    
-    SetLatency(mEngine.GetLatency());
-  }
 }
 
 template <class I, class O>
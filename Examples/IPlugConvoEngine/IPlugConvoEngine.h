@@ -10,6 +10,7 @@
 #endif
 
 #include "convoengine.h"
+#include "AsyncConvolver.h"
 
 #if defined USE_WDL_RESAMPLER
   #include "resample.h"
@@ -38,28 +39,28 @@ public:
   void ProcessBlock(sample** inputs, sample** outputs, int nFrames) override;
   void OnReset() override;
 private:
-  // Returns destination length
-  inline int ResampleLength(int srcLength, double srcRate, double destRate) const
-  {
-    return int(destRate / srcRate * (double)srcLength + 0.5);
-  }
+  // Sets up the resampler for the IR, called on the convolver's worker thread
+  void PrepareResampler(double srcRate, double destRate);
 
   template <class I, class O> void Resample(const I* pSrc, int srcLength, double srcRate, O* pDst, int dstLength, double dstRate);
   
   static const float mIR[512];
 
-  WDL_ImpulseBuffer mImpulse;
-//  WDL_ConvolutionEngine_Div mEngine; // < low latency version
-  WDL_ConvolutionEngine mEngine;
-  
   static constexpr int mBlockLength = 64;
 
   #if defined USE_WDL_RESAMPLER
   WDL_Resampler mResampler;
+  static constexpr const char* kResamplerID = "wdl-sinc";
   #elif defined USE_R8BRAIN
   std::unique_ptr<CDSPResampler16IR> mResampler;
+  static constexpr const char* kResamplerID = "r8brain-16ir";
+  #else
+  static constexpr const char* kResamplerID = "IPlugConvoEngine-linear";
   #endif
 
+  // Resamples the IR and builds the convolution engine on a worker thread. Declared after the resampler, so it stops its worker before the resampler is destroyed
+  AsyncConvolver mConvolver;
+
   double mSampleRate = 0.0;
 #endif
 };
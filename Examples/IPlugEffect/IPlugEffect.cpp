@@ -6,6 +6,7 @@ IPlugEffect::IPlugEffect(const InstanceInfo& info)
 : iplug::Plugin(info, MakeConfig(kNumParams, kNumPresets))
 {
   GetParam(kGain)->InitDouble("Gain", 0., 0., 100.0, 0.01, "%");
+  GetParam(kGain)->SetSmoothing(IParam::kSmoothLinear, 20.);
 
 #if IPLUG_EDITOR // http://bit.ly/2S64BDd
   mMakeGraphicsFunc = [&]() {
@@ -31,12 +32,25 @@ IPlugEffect::IPlugEffect(const InstanceInfo& info)
 #if IPLUG_DSP
 void IPlugEffect::ProcessBlock(sample** inputs, sample** outputs, int nFrames)
 {
-  const double gain = GetParam(kGain)->Value() / 100.;
+  const IParam* pGain = GetParam(kGain);
   const int nChans = NOutChansConnected();
   
-  for (int s = 0; s < nFrames; s++) {
-    for (int c = 0; c < nChans; c++) {
-      outputs[c][s] = inputs[c][s] * gain;
+  if (pGain->IsSmoothedBlockConstant()) {
+    const double gain = pGain->GetSmoothedValue() / 100.;
+    
+    for (int s = 0; s < nFrames; s++) {
+      for (int c = 0; c < nChans; c++) {
+        outputs[c][s] = inputs[c][s] * gain;
+      }
+    }
+  }
+  else {
+    const sample* pGainRamp = pGain->GetSmoothedBlock();
+    
+    for (int s = 0; s < nFrames; s++) {
+      for (int c = 0; c < nChans; c++) {
+        outputs[c][s] = inputs[c][s] * pGainRamp[s] / 100.;
+      }
     }
   }
 }
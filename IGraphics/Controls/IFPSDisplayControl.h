@@ -154,6 +154,14 @@ public:
       str.SetFormatted(32, "%.2f ms", avg * 1000.0f);
       g.DrawText(mTopLabelText, str.Get(), padded);
     }
+
+    const float textCacheHitRate = g.GetTextCacheHitRate();
+
+    if (textCacheHitRate >= 0.f)
+    {
+      str.SetFormatted(32, "Text cache %.1f %%", textCacheHitRate * 100.f);
+      g.DrawText(mCacheLabelText, str.Get(), padded);
+    }
   }
 private:
   int mStyle;
@@ -166,6 +174,7 @@ private:
   IText mAPILabelText = IText(14, GetColor(kFR), DEFAULT_FONT, EAlign::Near, EVAlign::Top);
   IText mTopLabelText = IText(18, GetColor(kFR), DEFAULT_FONT, EAlign::Far, EVAlign::Top);
   IText mBottomLabelText = IText(15, GetColor(kFR), DEFAULT_FONT, EAlign::Far, EVAlign::Bottom);
+  IText mCacheLabelText = IText(12, GetColor(kFR), DEFAULT_FONT, EAlign::Near, EVAlign::Middle);
 };
 
 END_IGRAPHICS_NAMESPACE
@@ -71,6 +71,9 @@
 
 #include <string>
 #include <map>
+#include <mutex>
+
+#include "stb_image.h"
 
 using namespace iplug;
 using namespace igraphics;
@@ -232,10 +235,23 @@ END_IPLUG_NAMESPACE
 
 #pragma mark -
 
+/** stb_image keeps its load options in globals, which are read by every decode, so they are set once here rather than per load as nvgCreateImage() does.
+ * That way decodes on the preload threads never race with a write */
+static void InitStbImageOptions()
+{
+  static std::once_flag sOptionsSet;
+  
+  std::call_once(sOptionsSet, []() {
+    stbi_set_unpremultiply_on_load(1);
+    stbi_convert_iphone_png_to_rgb(1);
+  });
+}
+
 IGraphicsNanoVG::IGraphicsNanoVG(IGEditorDelegate& dlg, int w, int h, int fps, float scale)
 : IGraphics(dlg, w, h, fps, scale)
 {
   DBGMSG("IGraphics NanoVG @ %i FPS\n", fps);
+  InitStbImageOptions();
   StaticStorage<IFontData>::Accessor storage(sFontCache);
   storage.Retain();
 }
@@ -303,7 +319,10 @@ IBitmap IGraphicsNanoVG::LoadBitmap(const char* name, int nStates, bool framesAr
       return IBitmap(); // return invalid IBitmap
     }
 
-    pAPIBitmap = LoadAPIBitmap(fullPathOrResourceID.Get(), sourceScale, resourceFound, ext);
+    pAPIBitmap = TakePreloadedBitmap(name, sourceScale);
+    
+    if (!pAPIBitmap)
+      pAPIBitmap = LoadAPIBitmap(fullPathOrResourceID.Get(), sourceScale, resourceFound, ext);
     
     storage.Add(pAPIBitmap, name, sourceScale);
 
@@ -345,13 +364,62 @@ APIBitmap* IGraphicsNanoVG::LoadAPIBitmap(const char* fileNameOrResID, int scale
 #endif
   if (location == EResourceLocation::kAbsolutePath)
   {
-    ScopedGLContext scopedGLCtx {this};
-    idx = nvgCreateImage(mVG, fileNameOrResID, nvgImageFlags);
+    // N.B. - equivalent to nvgCreateImage(), without setting the stb_image options, see InitStbImageOptions()
+    int w = 0, h = 0, n = 0;
+    unsigned char* pPixels = stbi_load(fileNameOrResID, &w, &h, &n, 4);
+    
+    if (pPixels)
+    {
+      ScopedGLContext scopedGLCtx {this};
+      idx = nvgCreateImageRGBA(mVG, w, h, nvgImageFlags, pPixels);
+      stbi_image_free(pPixels);
+    }
   }
 
   return new Bitmap(mVG, fileNameOrResID, scale, idx, location == EResourceLocation::kPreloadedTexture);
 }
 
+bool IGraphicsNanoVG::DecodeAPIBitmap(const char* fileNameOrResID, int scale, EResourceLocation location, const char* ext, DecodedBitmap& result)
+{
+  int w = 0, h = 0, n = 0;
+  unsigned char* pPixels = nullptr;
+  
+  // N.B. - the stb_image options are set once by InitStbImageOptions(), not here, as this runs on several threads at once
+#ifdef OS_WIN
+  if (location == EResourceLocation::kWinBinary)
+  {
+    int size = 0;
+    const void* pResData = LoadWinResource(fileNameOrResID, ext, size, GetWinModuleHandle());
+
+    if (pResData)
+      pPixels = stbi_load_from_memory((const unsigned char*) pResData, size, &w, &h, &n, 4);
+  }
+  else
+#endif
+  if (location == EResourceLocation::kAbsolutePath)
+  {
+    pPixels = stbi_load(fileNameOrResID, &w, &h, &n, 4);
+  }
+  
+  // N.B. - preloaded textures (kPreloadedTexture) are already on the GPU
+  if (!pPixels)
+    return false;
+  
+  result.mPixels.Resize(w * h * 4);
+  memcpy(result.mPixels.Get(), pPixels, w * h * 4);
+  result.mWidth = w;
+  result.mHeight = h;
+  stbi_image_free(pPixels);
+  
+  return true;
+}
+
+APIBitmap* IGraphicsNanoVG::UploadAPIBitmap(DecodedBitmap& decoded)
+{
+  ScopedGLContext scopedGLCtx {this};
+  return new Bitmap(mVG, decoded.mWidth, decoded.mHeight, decoded.mPixels.Get(), static_cast<float>(decoded.mScale), 1.f);
+}
+
 APIBitmap* IGraphicsNanoVG::LoadAPIBitmap(const char* name, const void* pData, int dataSize, int scale)
 {
   StaticStorage<APIBitmap>::Accessor storage(mBitmapCache);
@@ -466,6 +534,9 @@ void IGraphicsNanoVG::OnViewInitialized(void* pContext)
 
 void IGraphicsNanoVG::OnViewDestroyed()
 {
+  // font IDs belong to the context
+  mTextCache.Clear();
+
   // need to remove all the controls to free framebuffers, before deleting context
   RemoveAllControls();
 
@@ -622,14 +693,6 @@ IColor IGraphicsNanoVG::GetPoint(int x, int y)
 
 void IGraphicsNanoVG::PrepareAndMeasureText(const IText& text, const char* str, IRECT& r, double& x, double & y) const
 {
-  float fbounds[4];
-  
-  assert(nvgFindFont(mVG, text.mFont) != -1 && "No font found - did you forget to load it?");
-  
-  nvgFontBlur(mVG, 0);
-  nvgFontSize(mVG, text.mSize);
-  nvgFontFace(mVG, text.mFont);
-  
   int align = 0;
   
   switch (text.mAlign)
@@ -646,10 +709,36 @@ void IGraphicsNanoVG::PrepareAndMeasureText(const IText& text, const char* str,
     case EVAlign::Bottom:  align |= NVG_ALIGN_BOTTOM;  y = r.B;        break;
   }
   
+  // nanovg rasterizes and measures glyphs at the scale of the current transform (quantized as in nvg__getFontScale()), so that is part of the key
+  float xform[6];
+  nvgCurrentTransform(mVG, xform);
+  const double xformScale = std::min(std::round(0.5 * (std::sqrt(xform[0] * xform[0] + xform[2] * xform[2]) + std::sqrt(xform[1] * xform[1] + xform[3] * xform[3])) * 100.) / 100., 4.);
+  const double scale = GetTotalScale() * xformScale;
+  const TextMetrics* pMetrics = mTextCache.Find(text, str, scale);
+  
+  nvgFontBlur(mVG, 0);
+  nvgFontSize(mVG, text.mSize);
   nvgTextAlign(mVG, align);
-  nvgTextBounds(mVG, x, y, str, NULL, fbounds);
+
+  if (pMetrics)
+  {
+    nvgFontFaceId(mVG, pMetrics->fontID);
+  }
+  else
+  {
+    const int fontID = nvgFindFont(mVG, text.mFont);
+    
+    assert(fontID != -1 && "No font found - did you forget to load it?");
+    
+    // N.B. - measured at the origin so the bounds can be reused at any position
+    TextMetrics metrics { fontID, {} };
+    nvgFontFaceId(mVG, fontID);
+    nvgTextBounds(mVG, 0.f, 0.f, str, NULL, metrics.bounds);
+    pMetrics = mTextCache.Add(text, str, scale, std::move(metrics));
+  }
   
-  r = IRECT(fbounds[0], fbounds[1], fbounds[2], fbounds[3]);
+  const float* fbounds = pMetrics->bounds;
+  r = IRECT((float) (x + fbounds[0]), (float) (y + fbounds[1]), (float) (x + fbounds[2]), (float) (y + fbounds[3]));
 }
 
 float IGraphicsNanoVG::DoMeasureText(const IText& text, const char* str, IRECT& bounds) const
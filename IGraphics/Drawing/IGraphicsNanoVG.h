@@ -95,6 +95,7 @@ public:
   ~IGraphicsNanoVG();
 
   const char* GetDrawingAPIStr() override;
+  float GetTextCacheHitRate() const override { return mTextCache.GetHitRate(); }
 
   void BeginFrame() override;
   void EndFrame() override;
@@ -136,8 +137,11 @@ protected:
   APIBitmap* LoadAPIBitmap(const char* fileNameOrResID, int scale, EResourceLocation location, const char* ext) override;
   APIBitmap* LoadAPIBitmap(const char* name, const void* pData, int dataSize, int scale) override;
   APIBitmap* CreateAPIBitmap(int width, int height, float scale, double drawScale, bool cacheable = false) override;
+  bool DecodeAPIBitmap(const char* fileNameOrResID, int scale, EResourceLocation location, const char* ext, DecodedBitmap& result) override;
+  APIBitmap* UploadAPIBitmap(DecodedBitmap& decoded) override;
 
   bool LoadAPIFont(const char* fontID, const PlatformFontPtr& font) override;
+  void ClearTextCache() override { mTextCache.Clear(); }
 
   int AlphaChannel() const override { return 3; }
   
@@ -157,6 +161,13 @@ protected:
   void DoDrawText(const IText& text, const char* str, const IRECT& bounds, const IBlend* pBlend) override;
 
 private:
+  /** Cached measurement for a string, bounds are relative to the alignment anchor point */
+  struct TextMetrics
+  {
+    int fontID;
+    float bounds[4];
+  };
+
   void PrepareAndMeasureText(const IText& text, const char* str, IRECT& r, double& x, double & y) const;
   void PathTransformSetMatrix(const IMatrix& m) override;
   void SetClipRegion(const IRECT& r) override;
@@ -170,6 +181,7 @@ private:
   NVGcontext* mVG = nullptr;
   NVGframebuffer* mMainFrameBuffer = nullptr;
   int mInitialFBO = 0;
+  mutable ITextCache<TextMetrics> mTextCache;
 };
 
 END_IGRAPHICS_NAMESPACE
@@ -413,6 +413,44 @@ APIBitmap* IGraphicsSkia::LoadAPIBitmap(const char* name, const void* pData, int
   return new Bitmap(pData, dataSize, scale);
 }
 
+bool IGraphicsSkia::DecodeAPIBitmap(const char* fileNameOrResID, int scale, EResourceLocation location, const char* ext, DecodedBitmap& result)
+{
+  sk_sp<SkData> data;
+  
+#ifdef OS_WIN
+  if (location == EResourceLocation::kWinBinary)
+  {
+    int size = 0;
+    const void* pData = LoadWinResource(fileNameOrResID, ext, size, GetWinModuleHandle());
+    
+    if (pData)
+      data = SkData::MakeWithoutCopy(pData, size);
+  }
+  else
+#endif
+  if (location == EResourceLocation::kAbsolutePath)
+  {
+    data = SkData::MakeFromFileName(fileNameOrResID);
+  }
+  
+  if (!data)
+    return false;
+  
+  // Decode now rather than lazily on the first draw. GPU backends upload the raster image when it is first drawn
+  auto image = SkImages::DeferredFromEncodedData(data);
+  
+  if (image)
+    image = image->makeRasterImage();
+  
+  if (!image)
+    return false;
+  
+  result.mAPIBitmap = std::make_unique<Bitmap>(image, scale);
+  result.mWidth = image->width();
+  result.mHeight = image->height();
+  return true;
+}
+
 void IGraphicsSkia::OnViewInitialized(void* pContext)
 {
 #if defined IGRAPHICS_GL
@@ -684,30 +722,40 @@ bool IGraphicsSkia::LoadAPIFont(const char* fontID, const PlatformFontPtr& font)
   return false;
 }
 
-void IGraphicsSkia::PrepareAndMeasureText(const IText& text, const char* str, IRECT& r, double& x, double & y, SkFont& font) const
+const IGraphicsSkia::TextMetrics& IGraphicsSkia::PrepareAndMeasureText(const IText& text, const char* str, IRECT& r, double& x, double & y) const
 {
-  SkFontMetrics metrics;
-  SkPaint paint;
-  //SkRect bounds;
-  
-  StaticStorage<Font>::Accessor storage(sFontCache);
-  Font* pFont = storage.Find(text.mFont);
-  
-  assert(pFont && "No font found - did you forget to load it?");
-
-  font.setTypeface(pFont->mTypeface);
-  font.setHinting(SkFontHinting::kSlight);
-  font.setForceAutoHinting(false);
-  font.setSubpixel(true);
-  font.setSize(text.mSize * pFont->mData->GetHeightEMRatio());
+  const TextMetrics* pMetrics = mTextCache.Find(text, str, GetTotalScale());
   
-  // Draw / measure
-  const double textWidth = font.measureText(str, strlen(str), SkTextEncoding::kUTF8, nullptr/* &bounds*/);
-  font.getMetrics(&metrics);
+  if (!pMetrics)
+  {
+    SkFont font;
+    SkFontMetrics metrics;
+    
+    StaticStorage<Font>::Accessor storage(sFontCache);
+    Font* pFont = storage.Find(text.mFont);
+    
+    assert(pFont && "No font found - did you forget to load it?");
+
+    font.setEdging(SkFont::Edging::kSubpixelAntiAlias);
+    font.setTypeface(pFont->mTypeface);
+    font.setHinting(SkFontHinting::kSlight);
+    font.setForceAutoHinting(false);
+    font.setSubpixel(true);
+    font.setSize(text.mSize * pFont->mData->GetHeightEMRatio());
+    
+    // Measure and shape
+    const size_t length = strlen(str);
+    const double textWidth = font.measureText(str, length, SkTextEncoding::kUTF8, nullptr);
+    font.getMetrics(&metrics);
+    
+    TextMetrics textMetrics { textWidth, metrics.fAscent, metrics.fDescent, SkTextBlob::MakeFromText(str, length, font, SkTextEncoding::kUTF8) };
+    pMetrics = mTextCache.Add(text, str, GetTotalScale(), std::move(textMetrics));
+  }
   
+  const double textWidth = pMetrics->width;
   const double textHeight = text.mSize;
-  const double ascender = metrics.fAscent;
-  const double descender = metrics.fDescent;
+  const double ascender = pMetrics->ascender;
+  const double descender = pMetrics->descender;
   
   switch (text.mAlign)
   {
@@ -724,16 +772,15 @@ void IGraphicsSkia::PrepareAndMeasureText(const IText& text, const char* str, IR
   }
   
   r = IRECT((float) x, (float) y + ascender, (float) (x + textWidth), (float) (y + ascender + textHeight));
+  
+  return *pMetrics;
 }
 
 float IGraphicsSkia::DoMeasureText(const IText& text, const char* str, IRECT& bounds) const
 {
-  SkFont font;
-  font.setEdging(SkFont::Edging::kSubpixelAntiAlias);
-
   IRECT r = bounds;
   double x, y;
-  PrepareAndMeasureText(text, str, bounds, x, y, font);
+  PrepareAndMeasureText(text, str, bounds, x, y);
   DoMeasureTextRotation(text, r, bounds);
   return bounds.W();
 }
@@ -741,18 +788,19 @@ float IGraphicsSkia::DoMeasureText(const IText& text, const char* str, IRECT& bo
 void IGraphicsSkia::DoDrawText(const IText& text, const char* str, const IRECT& bounds, const IBlend* pBlend)
 {
   IRECT measured = bounds;
-  
-  SkFont font;
-  font.setEdging(SkFont::Edging::kSubpixelAntiAlias);
-
   double x, y;
 
-  PrepareAndMeasureText(text, str, measured, x, y, font);
+  const TextMetrics& metrics = PrepareAndMeasureText(text, str, measured, x, y);
+  
+  // N.B. - empty strings produce no blob
+  if (!metrics.blob)
+    return;
+  
   PathTransformSave();
   DoTextRotation(text, bounds, measured);
   SkPaint paint;
   paint.setColor(SkiaColor(text.mFGColor, pBlend));
-  mCanvas->drawSimpleText(str, strlen(str), SkTextEncoding::kUTF8, x, y, font, paint);
+  mCanvas->drawTextBlob(metrics.blob, x, y, paint);
   PathTransformRestore();
 }
 
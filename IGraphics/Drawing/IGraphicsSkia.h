@@ -18,6 +18,7 @@
 #include "include/core/SkPath.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkImage.h"
+#include "include/core/SkTextBlob.h"
 #include "include/gpu/GrDirectContext.h"
 #pragma warning( pop )
 
@@ -55,6 +56,7 @@ public:
   ~IGraphicsSkia();
 
   const char* GetDrawingAPIStr() override ;
+  float GetTextCacheHitRate() const override { return mTextCache.GetHitRate(); }
 
   void BeginFrame() override;
   void EndFrame() override;
@@ -136,11 +138,22 @@ protected:
   void DoDrawText(const IText& text, const char* str, const IRECT& bounds, const IBlend* pBlend) override;
 
   bool LoadAPIFont(const char* fontID, const PlatformFontPtr& font) override;
+  void ClearTextCache() override { mTextCache.Clear(); }
 
   APIBitmap* LoadAPIBitmap(const char* fileNameOrResID, int scale, EResourceLocation location, const char* ext) override;
   APIBitmap* LoadAPIBitmap(const char* name, const void* pData, int dataSize, int scale) override;
-private:  
-  void PrepareAndMeasureText(const IText& text, const char* str, IRECT& r, double& x, double & y, SkFont& font) const;
+  bool DecodeAPIBitmap(const char* fileNameOrResID, int scale, EResourceLocation location, const char* ext, DecodedBitmap& result) override;
+private:
+  /** Cached measurement and glyph run for a string, the blob is positioned relative to the text origin */
+  struct TextMetrics
+  {
+    double width;
+    double ascender;
+    double descender;
+    sk_sp<SkTextBlob> blob;
+  };
+
+  const TextMetrics& PrepareAndMeasureText(const IText& text, const char* str, IRECT& r, double& x, double & y) const;
 
   void PathTransformSetMatrix(const IMatrix& m) override;
   void SetClipRegion(const IRECT& r) override;
@@ -174,6 +187,8 @@ private:
   void* mMTLLayer;
 #endif
 
+  mutable ITextCache<TextMetrics> mTextCache;
+
   static StaticStorage<Font> sFontCache;
 };
 
@@ -106,6 +106,12 @@ IControl::IControl(const IRECT& bounds, IActionFunction aF)
 {
 }
 
+IControl::~IControl()
+{
+  if (mGraphics)
+    mGraphics->RemoveActiveControl(this);
+}
+
 int IControl::GetParamIdx(int valIdx) const
 {
   assert(valIdx > kNoValIdx && valIdx < NVals());
@@ -203,6 +209,7 @@ void IControl::SetDirty(bool triggerAction, int valIdx)
   ForValIdx(valIdx, setValue);
   
   mDirty = true;
+  MarkActive();
   
   if (triggerAction)
   {
@@ -426,6 +433,7 @@ void IControl::StartAnimation(int duration)
 {
   mAnimationStartTime = std::chrono::high_resolution_clock::now();
   mAnimationDuration = Milliseconds(duration);
+  MarkActive();
 }
 
 double IControl::GetAnimationProgress() const
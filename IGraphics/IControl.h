@@ -78,7 +78,7 @@ public:
   void operator=(const IControl&) = delete;
   
   /** Destructor. Clean up any resources that your control owns. */
-  virtual ~IControl() {}
+  virtual ~IControl();
 
   /** Implement this method to respond to a mouse down event on this control. 
    * @param x The X coordinate of the mouse event
@@ -412,9 +412,17 @@ public:
   void Animate();
 
   /** Called at each display refresh by the IGraphics draw loop, after IControl::Animate(), to determine if the control is marked as dirty. 
+   * NOTE: only controls that have been marked dirty, are animating or are always active are polled. If you override this method with logic that does not call SetDirty(), call SetAlwaysActive(true)
    * @return \c true if the control is marked dirty. */
   virtual bool IsDirty();
 
+  /** Keep the control in the IGraphics set of active controls, so that IsDirty() is polled at every display refresh, even when it has not been marked dirty
+   * @param alwaysActive Set true if the control decides for itself when it is dirty */
+  void SetAlwaysActive(bool alwaysActive) { mAlwaysActive = alwaysActive; if (alwaysActive) MarkActive(); }
+
+  /** @return \c true if IsDirty() is polled at every display refresh */
+  bool GetAlwaysActive() const { return mAlwaysActive; }
+
   /** Disable/enable default prompt for user input
    * @param disable Set true to disable prompt */
   void DisablePrompt(bool disable) { mDisablePrompt = disable; }
@@ -458,6 +466,10 @@ public:
   {
     mDelegate = &dlg;
     mGraphics = dlg.GetUI();
+    
+    if (mDirty || mAnimationFunc || mAlwaysActive)
+      MarkActive();
+    
     OnInit();
     OnResize();
     OnRescale();
@@ -494,12 +506,12 @@ public:
   
   /** Set the animation function
    * @param func A std::function conforming to IAnimationFunction */
-  void SetAnimation(IAnimationFunction func) { mAnimationFunc = func;}
+  void SetAnimation(IAnimationFunction func) { mAnimationFunc = func; MarkActive(); }
   
   /** Set the animation function and starts it
    * @param func A std::function conforming to IAnimationFunction
    * @param duration Duration in milliseconds for the animation */
-  void SetAnimation(IAnimationFunction func, int duration) { mAnimationFunc = func; StartAnimation(duration); }
+  void SetAnimation(IAnimationFunction func, int duration) { mAnimationFunc = func; MarkActive(); StartAnimation(duration); }
 
   /** Get the control's animation function, if it exists */
   IAnimationFunction GetAnimationFunction() { return mAnimationFunc; }
@@ -583,6 +595,15 @@ protected:
 #endif
   
 private:
+  friend class IGraphics;
+  
+  /** Add the control to the IGraphics set of active controls, so that it is visited at the next display refresh */
+  void MarkActive()
+  {
+    if (mGraphics)
+      mGraphics->AddActiveControl(this);
+  }
+  
   IContainerBase* mParent = nullptr;
   IGEditorDelegate* mDelegate = nullptr;
   IGraphics* mGraphics = nullptr;
@@ -594,6 +615,8 @@ private:
   std::vector<ParamTuple> mVals { {kNoParameter, 0.} };
   std::unordered_map<EGestureType, IGestureFunc> mGestureFuncs;
   EGestureType mLastGesture = EGestureType::Unknown;
+  bool mAlwaysActive = false;
+  bool mInActiveSet = false;
 };
 
 #pragma mark - Base Controls
@@ -64,6 +64,8 @@ IGraphics::~IGraphics()
   // Thus, this prevents a call to a pure virtual in ReleaseMouseCapture
     
   mCursorHidden = false;
+  assert(!mPreloader && "CancelPreloads() must be called before the derived IGraphics classes are destroyed");
+  CancelPreloads();
   RemoveAllControls();
     
   StaticStorage<APIBitmap>::Accessor bitmapStorage(sBitmapCache);
@@ -74,7 +76,27 @@ IGraphics::~IGraphics()
 
 void IGraphics::SetScreenScale(float scale)
 {
+  const int prevRoundedScale = GetRoundedScreenScale();
   mScreenScale = scale;
+  ClearTextCache();
+  
+  // Bitmaps preloaded for the previous screen scale (e.g. before the window was opened) are searched for again, and decodes at the old scale dropped
+  if (GetRoundedScreenScale() != prevRoundedScale && !mScreenScalePreloads.empty())
+  {
+    auto preloads = std::move(mScreenScalePreloads);
+    mScreenScalePreloads.clear();
+    
+    for (auto& preload : preloads)
+    {
+      PreloadBitmap(preload.first.c_str());
+      
+      auto it = mScreenScalePreloads.find(preload.first);
+      
+      if (it == mScreenScalePreloads.end() || it->second != preload.second)
+        mPendingBitmaps.erase(preload.second);
+    }
+  }
+  
   int windowWidth = WindowWidth() * GetPlatformWindowScale();
   int windowHeight = WindowHeight() * GetPlatformWindowScale();
   
@@ -98,6 +120,9 @@ void IGraphics::Resize(int w, int h, float scale, bool needsPlatformResize)
   //DBGMSG("resize %i, resize %i, scale %f\n", w, h, scale);
   ReleaseMouseCapture();
 
+  if (scale != mDrawScale)
+    ClearTextCache();
+
   mDrawScale = scale;
   mWidth = w;
   mHeight = h;
@@ -207,6 +232,7 @@ void IGraphics::RemoveAllControls()
   mLiveEdit = nullptr;
 #endif
   
+  mActiveControls.clear();
   mBubbleControls.Empty(true);
   
   mCtrlTags.clear();
@@ -601,7 +627,35 @@ void IGraphics::SetAllControlsDirty()
 
 void IGraphics::SetAllControlsClean()
 {
-  ForAllControls(&IControl::SetClean);
+  // Controls outside the active set cannot be dirty
+  for (auto pControl : mActiveControls)
+  {
+    if (pControl)
+      pControl->SetClean();
+  }
+}
+
+void IGraphics::AddActiveControl(IControl* pControl)
+{
+  if (!pControl->mInActiveSet)
+  {
+    pControl->mInActiveSet = true;
+    mActiveControls.push_back(pControl);
+  }
+}
+
+void IGraphics::RemoveActiveControl(IControl* pControl)
+{
+  if (pControl->mInActiveSet)
+  {
+    pControl->mInActiveSet = false;
+    
+    // Null the entry rather than erasing it, as this may be called while IsDirty() is iterating
+    auto it = std::find(mActiveControls.begin(), mActiveControls.end(), pControl);
+    
+    if (it != mActiveControls.end())
+      *it = nullptr;
+  }
 }
 
 void IGraphics::AssignParamNameToolTips()
@@ -842,11 +896,22 @@ bool IGraphics::IsDirty(IRECTList& rects)
   if (mDisplayTickFunc)
     mDisplayTickFunc();
 
-  ForAllControlsFunc([](IControl* pControl) { pControl->Animate(); } );
-
   bool dirty = false;
+  
+  // Only active controls need visiting. Iterate by index, since animation functions may activate other controls
+  for (size_t i = 0; i < mActiveControls.size(); i++)
+  {
+    if (mActiveControls[i])
+      mActiveControls[i]->Animate();
+  }
+  
+  for (size_t i = 0; i < mActiveControls.size(); i++)
+  {
+    IControl* pControl = mActiveControls[i];
+    
+    if (!pControl)
+      continue;
     
-  auto func = [&dirty, &rects](IControl* pControl) {
     if (pControl->IsDirty())
     {
       // N.B padding outlines for single line outlines
@@ -860,9 +925,15 @@ bool IGraphics::IsDirty(IRECTList& rects)
       rects.Add(rectToAdd);
       dirty = true;
     }
-  };
-    
-  ForAllControlsFunc(func);
+    else if (!pControl->GetAlwaysActive())
+    {
+      // The control is at rest, it will be added again when it is marked dirty or starts animating
+      pControl->mInActiveSet = false;
+      mActiveControls[i] = nullptr;
+    }
+  }
+  
+  mActiveControls.erase(std::remove(mActiveControls.begin(), mActiveControls.end(), nullptr), mActiveControls.end());
 
 #ifdef USE_IDLE_CALLS
   if (dirty)
@@ -1571,10 +1642,54 @@ void IGraphics::EnableLiveEdit(bool enable)
 #endif
 }
 
+#ifndef SVG_USE_SKIA
+/** Compute whether an SVG path is a hole or a solid, by counting crossings with the other paths of the shape
+ * @return \c true if the path should be wound clockwise */
+static bool GetSVGPathWinding(const NSVGshape* pShape, const NSVGpath* pPath)
+{
+  int crossings = 0;
+  IVec2 p0{pPath->pts[0], pPath->pts[1]};
+  IVec2 p1{pPath->bounds[0] - 1.0f, pPath->bounds[1] - 1.0f};
+  // Iterate all other paths
+  for (const NSVGpath* pPath2 = pShape->paths; pPath2; pPath2 = pPath2->next)
+  {
+    if (pPath2 == pPath)
+      continue;
+    // Iterate all lines on the path
+    if (pPath2->npts < 4)
+      continue;
+    for (int i = 1; i < pPath2->npts + 3; i += 3)
+    {
+      const float *p = &pPath2->pts[2*i];
+      // The previous point
+      IVec2 p2 {p[-2], p[-1]};
+      // The current point
+      IVec2 p3 = (i < pPath2->npts) ? IVec2{p[4], p[5]} : IVec2{pPath2->pts[0], pPath2->pts[1]};
+      float crossing = GetLineCrossing(p0, p1, p2, p3);
+      float crossing2 = GetLineCrossing(p2, p3, p0, p1);
+      if (0.0 <= crossing && crossing < 1.0 && 0.0 <= crossing2)
+      {
+        crossings++;
+      }
+    }
+  }
+  return crossings % 2 != 0;
+}
+#endif
+
 // Skia has its own implementation for SVGs. On all other platforms we use NanoSVG, because it works.
 #ifdef SVG_USE_SKIA
 ISVG IGraphics::LoadSVG(const char* fileName, const char* units, float dpi)
 {
+  auto pending = mPendingSVGs.find(fileName);
+  
+  // If the SVG is being preloaded, wait for it to arrive in the cache
+  if (pending != mPendingSVGs.end())
+  {
+    pending->second.wait();
+    mPendingSVGs.erase(pending);
+  }
+  
   StaticStorage<SVGHolder>::Accessor storage(sSVGCache);
   SVGHolder* pHolder = storage.Find(fileName);
   
@@ -1591,52 +1706,71 @@ ISVG IGraphics::LoadSVG(const char* fileName, const char* units, float dpi)
     }
   }
   
-  return ISVG(pHolder->mSVGDom);
+  return ISVG(pHolder->mSVGDom, pHolder->mPicture);
 }
 
-ISVG IGraphics::LoadSVG(const char* name, const void* pData, int dataSize, const char* units, float dpi)
+/** Parse SVG data into a new SVGHolder, does not touch the SVG cache so it is safe to call from any thread */
+static SVGHolder* CreateSVGHolder(const void* pData, int dataSize, const char* units, float dpi)
 {
-  StaticStorage<SVGHolder>::Accessor storage(sSVGCache);
-  SVGHolder* pHolder = storage.Find(name);
+  sk_sp<SkSVGDOM> svgDOM;
+  SkDOM xmlDom;
 
-  if (!pHolder)
+  SkMemoryStream svgStream(pData, dataSize);
+  svgDOM = SkSVGDOM::MakeFromStream(svgStream);
+  
+  if (!svgDOM)
+    return nullptr;
+
+  // If an SVG doesn't have a container size, SKIA doesn't seem to have access to any meaningful size info.
+  // So use NanoSVG to get the size.
+  if (svgDOM->containerSize().width() == 0)
   {
-    sk_sp<SkSVGDOM> svgDOM;
-    SkDOM xmlDom;
+    NSVGimage* pImage = nullptr;
 
-    SkMemoryStream svgStream(pData, dataSize);
-    svgDOM = SkSVGDOM::MakeFromStream(svgStream);
+    WDL_String svgStr;
+    svgStr.Set((const char*)pData, dataSize);
+    pImage = nsvgParse(svgStr.Get(), units, dpi);
     
-    if (!svgDOM)
-      return ISVG(nullptr); // return invalid SVG
+    assert(pImage);
 
-    // If an SVG doesn't have a container size, SKIA doesn't seem to have access to any meaningful size info.
-    // So use NanoSVG to get the size.
-    if (svgDOM->containerSize().width() == 0)
-    {
-      NSVGimage* pImage = nullptr;
+    svgDOM->setContainerSize(SkSize::Make(pImage->width, pImage->height));
 
-      WDL_String svgStr;
-      svgStr.Set((const char*)pData, dataSize);
-      pImage = nsvgParse(svgStr.Get(), units, dpi);
-      
-      assert(pImage);
+    nsvgDelete(pImage);
+  }
 
-      svgDOM->setContainerSize(SkSize::Make(pImage->width, pImage->height));
+  return new SVGHolder(svgDOM);
+}
 
-      nsvgDelete(pImage);
-    }
+ISVG IGraphics::LoadSVG(const char* name, const void* pData, int dataSize, const char* units, float dpi)
+{
+  StaticStorage<SVGHolder>::Accessor storage(sSVGCache);
+  SVGHolder* pHolder = storage.Find(name);
+
+  if (!pHolder)
+  {
+    pHolder = CreateSVGHolder(pData, dataSize, units, dpi);
+    
+    if (!pHolder)
+      return ISVG(nullptr); // return invalid SVG
 
-    pHolder = new SVGHolder(svgDOM);
     storage.Add(pHolder, name);
   }
 
-  return ISVG(pHolder->mSVGDom);
+  return ISVG(pHolder->mSVGDom, pHolder->mPicture);
 }
 
 #else
 ISVG IGraphics::LoadSVG(const char* fileName, const char* units, float dpi)
 {
+  auto pending = mPendingSVGs.find(fileName);
+  
+  // If the SVG is being preloaded, wait for it to arrive in the cache
+  if (pending != mPendingSVGs.end())
+  {
+    pending->second.wait();
+    mPendingSVGs.erase(pending);
+  }
+  
   StaticStorage<SVGHolder>::Accessor storage(sSVGCache);
   SVGHolder* pHolder = storage.Find(fileName);
 
@@ -1653,7 +1787,31 @@ ISVG IGraphics::LoadSVG(const char* fileName, const char* units, float dpi)
     }
   }
 
-  return ISVG(pHolder->mImage);
+  return ISVG(pHolder->mImage, &pHolder->mPathWindings);
+}
+
+/** Parse SVG data into a new SVGHolder, does not touch the SVG cache so it is safe to call from any thread */
+static SVGHolder* CreateSVGHolder(const void* pData, int dataSize, const char* units, float dpi)
+{
+  NSVGimage* pImage = nullptr;
+
+  WDL_String svgStr;
+  svgStr.Set(reinterpret_cast<const char*>(pData), dataSize);
+  pImage = nsvgParse(svgStr.Get(), units, dpi);
+
+  if (!pImage)
+    return nullptr;
+  
+  SVGHolder* pHolder = new SVGHolder(pImage);
+  
+  // Windings only depend on the geometry, so compute them once here rather than on every draw
+  for (NSVGshape* pShape = pImage->shapes; pShape; pShape = pShape->next)
+  {
+    for (NSVGpath* pPath = pShape->paths; pPath; pPath = pPath->next)
+      pHolder->mPathWindings.push_back(GetSVGPathWinding(pShape, pPath));
+  }
+  
+  return pHolder;
 }
 
 ISVG IGraphics::LoadSVG(const char* name, const void* pData, int dataSize, const char* units, float dpi)
@@ -1663,21 +1821,15 @@ ISVG IGraphics::LoadSVG(const char* name, const void* pData, int dataSize, const
 
   if (!pHolder)
   {
-    NSVGimage* pImage = nullptr;
+    pHolder = CreateSVGHolder(pData, dataSize, units, dpi);
 
-    WDL_String svgStr;
-    svgStr.Set(reinterpret_cast<const char*>(pData), dataSize);
-    pImage = nsvgParse(svgStr.Get(), units, dpi);
-
-    if (!pImage)
+    if (!pHolder)
       return ISVG(nullptr);
-    
-    pHolder = new SVGHolder(pImage);
 
     storage.Add(pHolder, name);
   }
 
-  return ISVG(pHolder->mImage);
+  return ISVG(pHolder->mImage, &pHolder->mPathWindings);
 }
 #endif
 
@@ -1773,10 +1925,14 @@ IBitmap IGraphics::LoadBitmap(const char* name, int nStates, bool framesAreHoriz
       if (sourceScale != targetScale)
         pAPIBitmap = storage.Find(name, sourceScale);
 
-      // Load the resource if no match found
+      // Load the resource if no match found, using the preloaded copy if there is one
       if (!pAPIBitmap)
       {
-        loadedBitmap = std::unique_ptr<APIBitmap>(LoadAPIBitmap(fullPath.Get(), sourceScale, resourceLocation, ext));
+        loadedBitmap = std::unique_ptr<APIBitmap>(TakePreloadedBitmap(name, sourceScale));
+        
+        if (!loadedBitmap)
+          loadedBitmap = std::unique_ptr<APIBitmap>(LoadAPIBitmap(fullPath.Get(), sourceScale, resourceLocation, ext));
+        
         pAPIBitmap= loadedBitmap.get();
       }
     }
@@ -1928,6 +2084,148 @@ APIBitmap* IGraphics::SearchBitmapInCache(const char* name, int targetScale, int
   return nullptr;
 }
 
+ResourcePreloader& IGraphics::GetPreloader()
+{
+  if (!mPreloader)
+    mPreloader = std::make_unique<ResourcePreloader>();
+  
+  return *mPreloader;
+}
+
+static std::string GetPreloadedBitmapKey(const char* name, int scale)
+{
+  return std::string(name) + "@" + std::to_string(scale);
+}
+
+void IGraphics::PreloadBitmap(const char* name, int targetScale)
+{
+  const bool followScreenScale = targetScale == 0;
+  
+  if (followScreenScale)
+    targetScale = GetRoundedScreenScale();
+  
+  const char* ext = name + strlen(name) - 1;
+  while (ext >= name && *ext != '.') --ext;
+  ++ext;
+  
+  if (!BitmapExtSupported(ext))
+    return;
+  
+  WDL_String fullPath;
+  int sourceScale = 0;
+  EResourceLocation location = SearchImageResource(name, ext, fullPath, targetScale, sourceScale);
+  
+  if (location == EResourceLocation::kNotFound)
+    return;
+  
+  {
+    StaticStorage<APIBitmap>::Accessor storage(sBitmapCache);
+    
+    if (storage.Find(name, sourceScale))
+      return;
+  }
+  
+  std::string key = GetPreloadedBitmapKey(name, sourceScale);
+  
+  if (followScreenScale)
+    mScreenScalePreloads[name] = key;
+  
+  if (mPendingBitmaps.find(key) != mPendingBitmaps.end())
+    return;
+  
+  std::string path(fullPath.Get());
+  std::string extension(ext);
+  
+  mPendingBitmaps[key] = GetPreloader().Add<DecodedBitmapPtr>([this, path, extension, sourceScale, location]() {
+    auto pDecoded = std::make_unique<DecodedBitmap>();
+    
+    if (!DecodeAPIBitmap(path.c_str(), sourceScale, location, extension.c_str(), *pDecoded))
+      return DecodedBitmapPtr();
+    
+    pDecoded->mScale = sourceScale;
+    return pDecoded;
+  });
+}
+
+APIBitmap* IGraphics::TakePreloadedBitmap(const char* name, int scale)
+{
+  auto pending = mPendingBitmaps.find(GetPreloadedBitmapKey(name, scale));
+  
+  if (pending == mPendingBitmaps.end())
+    return nullptr;
+  
+  DecodedBitmapPtr pDecoded = pending->second.get();
+  mPendingBitmaps.erase(pending);
+  mScreenScalePreloads.erase(name);
+  
+  return pDecoded ? UploadAPIBitmap(*pDecoded) : nullptr;
+}
+
+void IGraphics::PreloadSVG(const char* name, const char* units, float dpi)
+{
+  {
+    StaticStorage<SVGHolder>::Accessor storage(sSVGCache);
+    
+    if (storage.Find(name))
+      return;
+  }
+  
+  if (mPendingSVGs.find(name) != mPendingSVGs.end())
+    return;
+  
+  std::string svgName(name);
+  std::string svgUnits(units);
+  
+  mPendingSVGs[svgName] = GetPreloader().Add<bool>([this, svgName, svgUnits, dpi]() {
+    WDL_TypedBuf<uint8_t> svgData = LoadResource(svgName.c_str(), "svg");
+    
+    if (svgData.GetSize() == 0)
+      return false;
+    
+    // N.B. - parse outside of the cache lock, so that other SVGs can be parsed in parallel
+    SVGHolder* pHolder = CreateSVGHolder(svgData.Get(), svgData.GetSize(), svgUnits.c_str(), dpi);
+    
+    if (!pHolder)
+      return false;
+    
+    StaticStorage<SVGHolder>::Accessor storage(sSVGCache);
+    
+    if (storage.Find(svgName.c_str()))
+      delete pHolder;
+    else
+      storage.Add(pHolder, svgName.c_str());
+    
+    return true;
+  });
+}
+
+void IGraphics::PreloadFont(const char* fontID, const char* fileNameOrResID)
+{
+  if (mPendingFonts.find(fontID) != mPendingFonts.end())
+    return;
+  
+  std::string id(fontID);
+  std::string fileName(fileNameOrResID);
+  
+  mPendingFonts[id] = GetPreloader().Add<PlatformFontPtr>([this, id, fileName]() {
+    return LoadPlatformFont(id.c_str(), fileName.c_str());
+  });
+}
+
+void IGraphics::CancelPreloads()
+{
+  if (mPreloader)
+  {
+    mPreloader->Stop();
+    mPreloader = nullptr;
+  }
+  
+  mPendingBitmaps.clear();
+  mScreenScalePreloads.clear();
+  mPendingSVGs.clear();
+  mPendingFonts.clear();
+}
+
 void IGraphics::StyleAllVectorControls(const IVStyle& style)
 {
   for (auto c = 0; c < NControls(); c++)
@@ -2092,6 +2390,123 @@ void IGraphics::DrawRotatedLayer(const ILayerPtr& layer, double angle)
   PathTransformRestore();
 }
 
+/** Compute the widths of three box filters whose repeated application approximates a gaussian with standard deviation sigma */
+static void GetGaussianBoxSizes(float sigma, int sizes[3])
+{
+  const int n = 3;
+  const float wIdeal = std::sqrt((12.f * sigma * sigma / n) + 1.f);
+  int wl = static_cast<int>(std::floor(wIdeal));
+  
+  if (wl % 2 == 0)
+    wl--;
+  
+  const int wu = wl + 2;
+  const float mIdeal = (12.f * sigma * sigma - n * wl * wl - 4.f * n * wl - 3.f * n) / (-4.f * wl - 4.f);
+  const int m = static_cast<int>(std::round(mIdeal));
+  
+  for (int i = 0; i < n; i++)
+    sizes[i] = i < m ? wl : wu;
+}
+
+/** Box blur the columns of a plane using a running sum, so the cost per pixel is independent of the radius.
+ * Whole rows are processed at a time, so the inner loops are contiguous and vectorize. Pixels outside the plane are treated as zero */
+static void BoxBlurColumns(const float* pIn, float* pOut, float* pSum, int width, int height, int radius)
+{
+  const float norm = 1.f / static_cast<float>(2 * radius + 1);
+  
+  std::fill(pSum, pSum + width, 0.f);
+  
+  for (int y = 0; y < std::min(radius, height); y++)
+  {
+    const float* pRow = pIn + y * width;
+    
+    for (int x = 0; x < width; x++)
+      pSum[x] += pRow[x];
+  }
+  
+  for (int y = 0; y < height; y++)
+  {
+    if (y + radius < height)
+    {
+      const float* pAdd = pIn + (y + radius) * width;
+      
+      for (int x = 0; x < width; x++)
+        pSum[x] += pAdd[x];
+    }
+    
+    float* pRow = pOut + y * width;
+    
+    for (int x = 0; x < width; x++)
+      pRow[x] = pSum[x] * norm;
+    
+    if (y - radius >= 0)
+    {
+      const float* pSub = pIn + (y - radius) * width;
+      
+      for (int x = 0; x < width; x++)
+        pSum[x] -= pSub[x];
+    }
+  }
+}
+
+/** Transpose a plane in cache sized blocks */
+static void TransposePlane(const float* pIn, float* pOut, int width, int height)
+{
+  const int blockSize = 16;
+  
+  for (int y0 = 0; y0 < height; y0 += blockSize)
+  {
+    for (int x0 = 0; x0 < width; x0 += blockSize)
+    {
+      const int yEnd = std::min(y0 + blockSize, height);
+      const int xEnd = std::min(x0 + blockSize, width);
+      
+      for (int y = y0; y < yEnd; y++)
+      {
+        for (int x = x0; x < xEnd; x++)
+          pOut[x * height + y] = pIn[y * width + x];
+      }
+    }
+  }
+}
+
+/** Approximate a gaussian blur of an 8-bit plane with three box blurs in each direction */
+static void BoxBlurPlane(uint8_t* pPlane, int width, int height, float sigma)
+{
+  int sizes[3];
+  GetGaussianBoxSizes(sigma, sizes);
+  
+  const int size = width * height;
+  std::vector<float> buffer(size * 2 + std::max(width, height));
+  float* pA = buffer.data();
+  float* pB = pA + size;
+  float* pSum = pB + size;
+  
+  for (int i = 0; i < size; i++)
+    pA[i] = pPlane[i];
+  
+  // Vertical passes, then transpose so the horizontal passes can also run along contiguous rows
+  for (int i = 0; i < 3; i++)
+  {
+    BoxBlurColumns(pA, pB, pSum, width, height, (sizes[i] - 1) / 2);
+    std::swap(pA, pB);
+  }
+  
+  TransposePlane(pA, pB, width, height);
+  std::swap(pA, pB);
+  
+  for (int i = 0; i < 3; i++)
+  {
+    BoxBlurColumns(pA, pB, pSum, height, width, (sizes[i] - 1) / 2);
+    std::swap(pA, pB);
+  }
+  
+  TransposePlane(pA, pB, height, width);
+  
+  for (int i = 0; i < size; i++)
+    pPlane[i] = static_cast<uint8_t>(std::min(255.f, pB[i] + 0.5f));
+}
+
 void IGraphics::ApplyLayerDropShadow(ILayerPtr& layer, const IShadow& shadow)
 {
   auto GaussianBlurSwap = [](uint8_t* out, uint8_t* in, uint8_t* kernel, int width, int height,
@@ -2150,44 +2565,114 @@ void IGraphics::ApplyLayerDropShadow(ILayerPtr& layer, const IShadow& shadow)
   RawBitmapData temp1;
   RawBitmapData temp2;
   RawBitmapData kernel;
+  RawBitmapData alpha;
     
   // Get bitmap in 32-bit form
   GetLayerBitmapData(layer, temp1);
     
   if (!temp1.GetSize())
       return;
-  temp2.Resize(temp1.GetSize());
     
   // Form kernel (reference blurSize from zero (which will be no blur))
   bool flipped = FlippedBitmap();
   float scale = layer->GetAPIBitmap()->GetScale() * layer->GetAPIBitmap()->GetDrawScale();
   float blurSize = std::max(1.f, (shadow.mBlurSize * scale) + 1.f);
-  float blurConst = 4.5f / (blurSize * blurSize);
-  int iSize = static_cast<int>(ceil(blurSize));
   int width = layer->GetAPIBitmap()->GetWidth();
   int height = layer->GetAPIBitmap()->GetHeight();
-  int stride1 = temp1.GetSize() / width;
-  int stride2 = flipped ? -temp1.GetSize() / height : temp1.GetSize() / height;
-  int stride3 = flipped ? -stride2 : stride2;
-
-  kernel.Resize(iSize);
-        
-  for (int i = 0; i < iSize; i++)
-    kernel.Get()[i] = static_cast<uint8_t>(std::round(255.f * std::expf(-(i * i) * blurConst)));
+  int rowBytes = temp1.GetSize() / height;
+  
+  // Gather the alpha channel. Flipped bitmaps are read bottom up, as the mask is applied upside down
+  alpha.Resize(width * height);
   
-  // Kernel normalisation
-  int normFactor = kernel.Get()[0];
+  for (int y = 0; y < height; y++)
+  {
+    const uint8_t* pRow = temp1.Get() + AlphaChannel() + (flipped ? height - 1 - y : y) * rowBytes;
+    uint8_t* pAlpha = alpha.Get() + y * width;
     
-  for (int i = 1; i < iSize; i++)
-    normFactor += kernel.Get()[i] + kernel.Get()[i];
+    for (int x = 0; x < width; x++)
+      pAlpha[x] = pRow[x * 4];
+  }
   
-  // Do blur
-  uint8_t* asRows = temp1.Get() + AlphaChannel();
-  uint8_t* inRows = flipped ? asRows + stride3 * (height - 1) : asRows;
-  uint8_t* asCols = temp2.Get() + AlphaChannel();
+  // Layers with unchanged contents (or identical layers in several controls) reuse the previous mask
+  const size_t hash = std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(alpha.Get()), alpha.GetSize()));
   
-  GaussianBlurSwap(asCols, inRows, kernel.Get(), width, height, stride1, stride2, iSize, normFactor);
-  GaussianBlurSwap(asRows, asCols, kernel.Get(), height, width, stride3, stride1, iSize, normFactor);
+  auto IsMatch = [&](const ShadowMask& cached) {
+    return cached.hash == hash && cached.width == width && cached.height == height && cached.blurSize == blurSize
+      && cached.precise == shadow.mPreciseBlur && !memcmp(cached.source.Get(), alpha.Get(), alpha.GetSize());
+  };
+  
+  auto it = std::find_if(mShadowMaskCache.begin(), mShadowMaskCache.end(), IsMatch);
+  
+  if (it != mShadowMaskCache.end())
+  {
+    mShadowMaskCache.splice(mShadowMaskCache.begin(), mShadowMaskCache, it);
+  }
+  else
+  {
+    if (mShadowMaskCache.size() >= kMaxCachedShadowMasks)
+      mShadowMaskCache.pop_back();
+    
+    mShadowMaskCache.push_front({width, height, blurSize, shadow.mPreciseBlur, hash, alpha, {}});
+    RawBitmapData& mask = mShadowMaskCache.front().mask;
+    
+    if (shadow.mPreciseBlur)
+    {
+      float blurConst = 4.5f / (blurSize * blurSize);
+      int iSize = static_cast<int>(ceil(blurSize));
+      int stride1 = temp1.GetSize() / width;
+      int stride2 = flipped ? -temp1.GetSize() / height : temp1.GetSize() / height;
+      int stride3 = flipped ? -stride2 : stride2;
+
+      temp2.Resize(temp1.GetSize());
+      kernel.Resize(iSize);
+            
+      for (int i = 0; i < iSize; i++)
+        kernel.Get()[i] = static_cast<uint8_t>(std::round(255.f * std::expf(-(i * i) * blurConst)));
+      
+      // Kernel normalisation
+      int normFactor = kernel.Get()[0];
+        
+      for (int i = 1; i < iSize; i++)
+        normFactor += kernel.Get()[i] + kernel.Get()[i];
+      
+      // Do blur
+      uint8_t* asRows = temp1.Get() + AlphaChannel();
+      uint8_t* inRows = flipped ? asRows + stride3 * (height - 1) : asRows;
+      uint8_t* asCols = temp2.Get() + AlphaChannel();
+      
+      GaussianBlurSwap(asCols, inRows, kernel.Get(), width, height, stride1, stride2, iSize, normFactor);
+      GaussianBlurSwap(asRows, asCols, kernel.Get(), height, width, stride3, stride1, iSize, normFactor);
+      
+      mask.Resize(width * height);
+      
+      for (int y = 0; y < height; y++)
+      {
+        const uint8_t* pRow = asRows + y * rowBytes;
+        uint8_t* pMask = mask.Get() + y * width;
+        
+        for (int x = 0; x < width; x++)
+          pMask[x] = pRow[x * 4];
+      }
+    }
+    else
+    {
+      // The gaussian kernel above has a standard deviation of blurSize / 3
+      mask = alpha;
+      BoxBlurPlane(mask.Get(), width, height, blurSize / 3.f);
+    }
+  }
+  
+  // Write the mask back into the alpha channel
+  const RawBitmapData& mask = mShadowMaskCache.front().mask;
+  
+  for (int y = 0; y < height; y++)
+  {
+    uint8_t* pRow = temp1.Get() + AlphaChannel() + y * rowBytes;
+    const uint8_t* pMask = mask.Get() + y * width;
+    
+    for (int x = 0; x < width; x++)
+      pRow[x * 4] = pMask[x];
+  }
   
   // Apply alphas to the pattern and recombine/replace the image
   ApplyShadowMask(layer, temp1, shadow);
@@ -2195,13 +2680,24 @@ void IGraphics::ApplyLayerDropShadow(ILayerPtr& layer, const IShadow& shadow)
 
 bool IGraphics::LoadFont(const char* fontID, const char* fileNameOrResID)
 {
-  PlatformFontPtr font = LoadPlatformFont(fontID, fileNameOrResID);
+  PlatformFontPtr font;
+  auto pending = mPendingFonts.find(fontID);
+  
+  if (pending != mPendingFonts.end())
+  {
+    font = pending->second.get();
+    mPendingFonts.erase(pending);
+  }
+  
+  if (!font)
+    font = LoadPlatformFont(fontID, fileNameOrResID);
   
   if (font)
   {
     if (LoadAPIFont(fontID, font))
     {
       CachePlatformFont(fontID, font);
+      ClearTextCache();
       return true;
     }
   }
@@ -2219,6 +2715,7 @@ bool IGraphics::LoadFont(const char* fontID, void* pData, int dataSize)
     if (LoadAPIFont(fontID, font))
     {
       CachePlatformFont(fontID, font);
+      ClearTextCache();
       return true;
     }
   }
@@ -2236,6 +2733,7 @@ bool IGraphics::LoadFont(const char* fontID, const char* fontName, ETextStyle st
     if (LoadAPIFont(fontID, font))
     {
       CachePlatformFont(fontID, font);
+      ClearTextCache();
       return true;
     }
   }
@@ -2868,16 +3366,28 @@ void IGraphics::DoDrawSVG(const ISVG& svg, const IBlend* pBlend, const IColor* p
 {
 #ifdef SVG_USE_SKIA
   SkCanvas* canvas = static_cast<SkCanvas*>(GetDrawContext());
-  svg.mSVGDom->render(canvas); //TODO: blend
+  
+  if (svg.mPicture)
+    canvas->drawPicture(svg.mPicture); //TODO: blend
+  else
+    svg.mSVGDom->render(canvas); //TODO: blend
 #else
   NSVGimage* pImage = svg.mImage;
   
   assert(pImage != nullptr);
   
+  const std::vector<bool>* pWindings = svg.mPathWindings;
+  int pathIdx = -1;
+  
   for (NSVGshape* pShape = pImage->shapes; pShape; pShape = pShape->next)
   {
     if (!(pShape->flags & NSVG_FLAGS_VISIBLE))
+    {
+      for (NSVGpath* pPath = pShape->paths; pPath; pPath = pPath->next)
+        pathIdx++;
+      
       continue;
+    }
     
     // Build a new path for each shape
     PathClear();
@@ -2885,6 +3395,8 @@ void IGraphics::DoDrawSVG(const ISVG& svg, const IBlend* pBlend, const IColor* p
     // iterate subpaths in this shape
     for (NSVGpath* pPath = pShape->paths; pPath; pPath = pPath->next)
     {
+      pathIdx++;
+      
       PathMoveTo(pPath->pts[0], pPath->pts[1]);
       
       for (int i = 1; i < pPath->npts; i += 3)
@@ -2896,34 +3408,9 @@ void IGraphics::DoDrawSVG(const ISVG& svg, const IBlend* pBlend, const IColor* p
       if (pPath->closed)
         PathClose();
       
-      // Compute whether this path is a hole or a solid and set the winding direction accordingly.
-      int crossings = 0;
-      IVec2 p0{pPath->pts[0], pPath->pts[1]};
-      IVec2 p1{pPath->bounds[0] - 1.0f, pPath->bounds[1] - 1.0f};
-      // Iterate all other paths
-      for (NSVGpath *pPath2 = pShape->paths; pPath2; pPath2 = pPath2->next)
-      {
-        if (pPath2 == pPath)
-          continue;
-        // Iterate all lines on the path
-        if (pPath2->npts < 4)
-          continue;
-        for (int i = 1; i < pPath2->npts + 3; i += 3)
-        {
-          float *p = &pPath2->pts[2*i];
-          // The previous point
-          IVec2 p2 {p[-2], p[-1]};
-          // The current point
-          IVec2 p3 = (i < pPath2->npts) ? IVec2{p[4], p[5]} : IVec2{pPath2->pts[0], pPath2->pts[1]};
-          float crossing = GetLineCrossing(p0, p1, p2, p3);
-          float crossing2 = GetLineCrossing(p2, p3, p0, p1);
-          if (0.0 <= crossing && crossing < 1.0 && 0.0 <= crossing2)
-          {
-            crossings++;
-          }
-        }
-      }
-      PathSetWinding(crossings % 2 != 0);
+      // Set the winding direction according to whether this path is a hole or a solid
+      const bool clockwise = pWindings ? (*pWindings)[pathIdx] : GetSVGPathWinding(pShape, pPath);
+      PathSetWinding(clockwise);
     }
     
     // Fill combined path using windings set in subpaths
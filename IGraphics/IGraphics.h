@@ -374,6 +374,9 @@ public:
 
   /** @return A CString representing the Drawing API in use e.g. "NanoVG" */
   virtual const char* GetDrawingAPIStr() = 0;
+
+  /** @return The proportion (0-1) of text measurements served from the drawing backend's text cache, or a negative value if the backend does not cache text */
+  virtual float GetTextCacheHitRate() const { return -1.f; }
   
   /** Returns a new IBitmap, an integer scaled version of the input, and adds it to the cache
    * @param inbitmap The source bitmap to be scaled
@@ -1491,8 +1494,16 @@ public:
   /** Calls SetDirty() on every control */
   void SetAllControlsDirty();
   
-  /** Calls SetClean() on every control */
+  /** Calls SetClean() on every control that may be dirty */
   void SetAllControlsClean();
+  
+  /** Used internally to add a control to the set of active controls, i.e. those that are animating, dirty or always active. Only these are visited by IsDirty()
+   * @param pControl The control to add */
+  void AddActiveControl(IControl* pControl);
+  
+  /** Used internally to remove a control from the set of active controls, e.g. when it is destroyed
+   * @param pControl The control to remove */
+  void RemoveActiveControl(IControl* pControl);
     
   /** Reposition a control, redrawing the interface correctly
    * @param pControl The control
@@ -1704,6 +1715,28 @@ public:
    * @return A WDL_TypedBuf containing the data, or with a length of 0 if the resource was not found */
   virtual WDL_TypedBuf<uint8_t> LoadResource(const char* fileNameOrResID, const char* fileType);
 
+  /** Start decoding a bitmap on a worker thread, so that a later call to LoadBitmap() with the same name only has to hand it to the drawing backend.
+   * To start before the window is opened, e.g. in the plug-in's constructor, call IGEditorDelegate::PreloadBitmap() instead.
+   * LoadBitmap() waits for the decode if it has not finished yet, and loads the bitmap as normal if the backend cannot decode off the graphics thread
+   * @param fileNameOrResID CString file name or resource ID, as it will be passed to LoadBitmap()
+   * @param targetScale The scale that LoadBitmap() will ask for, or 0 to use the screen scale. In that case the bitmap is searched for again if the screen scale changes before it is loaded */
+  void PreloadBitmap(const char* fileNameOrResID, int targetScale = 0);
+
+  /** Start parsing an SVG on a worker thread and add it to the shared SVG cache. LoadSVG() waits for the parse if it has not finished yet
+   * @param fileNameOrResID CString file name or resource ID, as it will be passed to LoadSVG()
+   * @param units The length units used in the SVG (e.g. "px", "pt", "mm")
+   * @param dpi The dots per inch of the SVG file */
+  void PreloadSVG(const char* fileNameOrResID, const char* units = "px", float dpi = 72.f);
+
+  /** Start loading a font on a worker thread. LoadFont() with the same fontID waits for it if it has not finished yet
+   * @param fontID CString that will be used to reference the font
+   * @param fileNameOrResID CString file name or resource ID, as it will be passed to LoadFont() */
+  void PreloadFont(const char* fontID, const char* fileNameOrResID);
+
+  /** Discard any preloaded resources that have not been used, waiting for those that are still loading.
+   * The workers call virtual methods, so this must be called before a derived class is destroyed. IGEditorDelegate calls it when the window is closed, and before destroying the IGraphics */
+  void CancelPreloads();
+
   /** Registers a gesture recognizer with the graphics context
    * @param type The type of gesture recognizer */
   virtual void AttachGestureRecognizer(EGestureType type);
@@ -1748,6 +1781,29 @@ protected:
    * @param font Valid PlatformFontPtr, loaded via LoadPlatformFont
    * @return bool \c true if the font was loaded successfully */
   virtual bool LoadAPIFont(const char* fontID, const PlatformFontPtr& font) = 0;
+
+  /** Drawing API method to discard cached text measurements and glyph data, called internally when fonts are loaded or the scale changes */
+  virtual void ClearTextCache() {}
+
+  /** Drawing API method to decode a bitmap into memory, called on a worker thread by PreloadBitmap(). Implementations must not use the graphics context
+   * @param fileNameOrResID The resolved file path or resource ID
+   * @param scale Integer scale of the resource
+   * @param location The location of the resource, as returned by SearchImageResource()
+   * @param ext The file extension
+   * @param result The DecodedBitmap to fill
+   * @return \c true if the bitmap was decoded, \c false if it could not be decoded off the graphics thread */
+  virtual bool DecodeAPIBitmap(const char* fileNameOrResID, int scale, EResourceLocation location, const char* ext, DecodedBitmap& result) { return false; }
+
+  /** Drawing API method to create an APIBitmap from the result of DecodeAPIBitmap(), called on the graphics thread
+   * @param decoded The decoded bitmap
+   * @return APIBitmap* The new API bitmap */
+  virtual APIBitmap* UploadAPIBitmap(DecodedBitmap& decoded) { return decoded.mAPIBitmap.release(); }
+
+  /** Take a bitmap started by PreloadBitmap(), waiting for it to finish decoding if necessary
+   * @param name The name that was passed to PreloadBitmap()
+   * @param scale The scale of the resource that was found
+   * @return APIBitmap* The new API bitmap (owned by the caller), or nullptr if the bitmap was not preloaded */
+  APIBitmap* TakePreloadedBitmap(const char* name, int scale);
     
   /** @return int The index of the alpha component in a drawing backend's pixel (RGBA or ARGB) */
   virtual int AlphaChannel() const = 0;
@@ -1822,6 +1878,7 @@ private:
   
   WDL_PtrList<IControl> mControls;
   std::unordered_map<int, IControl*> mCtrlTags;
+  std::vector<IControl*> mActiveControls; // controls that are animating, dirty or always active. Removed entries are nulled and compacted in IsDirty()
 
   // Order (front-to-back) ToolTip / PopUp / TextEntry / LiveEdit / Corner / PerfDisplay
   std::unique_ptr<ICornerResizerControl> mCornerResizer;
@@ -1877,6 +1934,29 @@ private:
   IDisplayTickFunc mDisplayTickFunc = nullptr;
   IUIAppearanceChangedFunc mAppearanceChangedFunc = nullptr;
   ILiveEditEventFunc mLiveEditEventFunc = nullptr;
+
+  ResourcePreloader& GetPreloader();
+  
+  std::unique_ptr<ResourcePreloader> mPreloader;
+  std::unordered_map<std::string, std::future<DecodedBitmapPtr>> mPendingBitmaps;
+  std::unordered_map<std::string, std::string> mScreenScalePreloads; // bitmap name -> pending key, for bitmaps preloaded at the screen scale
+  std::unordered_map<std::string, std::future<bool>> mPendingSVGs;
+  std::unordered_map<std::string, std::future<PlatformFontPtr>> mPendingFonts;
+
+  /** A blurred drop shadow mask, cached against the alpha channel and settings it was computed from */
+  struct ShadowMask
+  {
+    int width;
+    int height;
+    float blurSize;
+    bool precise;
+    size_t hash;
+    RawBitmapData source;
+    RawBitmapData mask;
+  };
+  
+  static constexpr int kMaxCachedShadowMasks = 16;
+  std::list<ShadowMask> mShadowMaskCache;
   
 protected:
   IGEditorDelegate* mDelegate;
@@ -22,13 +22,23 @@ IGEditorDelegate::IGEditorDelegate(int nParams)
 
 IGEditorDelegate::~IGEditorDelegate()
 {
+  // The preload workers call IGraphics virtuals, so they must be stopped before the derived IGraphics classes are destroyed
+  if (mGraphics)
+    mGraphics->CancelPreloads();
+  
+  if (mPreloadGraphics)
+    mPreloadGraphics->CancelPreloads();
 }
 
 void* IGEditorDelegate::OpenWindow(void* pParent)
 {
   if(!mGraphics)
   {
-    mGraphics = std::unique_ptr<IGraphics>(CreateGraphics());
+    if (mPreloadGraphics)
+      mGraphics = std::move(mPreloadGraphics);
+    else
+      mGraphics = std::unique_ptr<IGraphics>(CreateGraphics());
+    
     if (mLastWidth && mLastHeight && mLastScale)
       GetUI()->Resize(mLastWidth, mLastHeight, mLastScale);
   }
@@ -51,6 +61,7 @@ void IGEditorDelegate::CloseWindow()
       mLastWidth = mGraphics->Width();
       mLastHeight = mGraphics->Height();
       mLastScale = mGraphics->GetDrawScale();
+      mGraphics->CancelPreloads();
       mGraphics->CloseWindow();
       mGraphics = nullptr;
     }
@@ -59,6 +70,35 @@ void IGEditorDelegate::CloseWindow()
   }
 }
 
+IGraphics* IGEditorDelegate::GetPreloadGraphics()
+{
+  if (mGraphics)
+    return mGraphics.get();
+  
+  if (!mPreloadGraphics)
+    mPreloadGraphics = std::unique_ptr<IGraphics>(CreateGraphics());
+  
+  return mPreloadGraphics.get();
+}
+
+void IGEditorDelegate::PreloadBitmap(const char* fileNameOrResID, int targetScale)
+{
+  if (IGraphics* pGraphics = GetPreloadGraphics())
+    pGraphics->PreloadBitmap(fileNameOrResID, targetScale);
+}
+
+void IGEditorDelegate::PreloadSVG(const char* fileNameOrResID, const char* units, float dpi)
+{
+  if (IGraphics* pGraphics = GetPreloadGraphics())
+    pGraphics->PreloadSVG(fileNameOrResID, units, dpi);
+}
+
+void IGEditorDelegate::PreloadFont(const char* fontID, const char* fileNameOrResID)
+{
+  if (IGraphics* pGraphics = GetPreloadGraphics())
+    pGraphics->PreloadFont(fontID, fileNameOrResID);
+}
+
 void IGEditorDelegate::OnParentWindowResize(int width, int height)
 {
   if (auto* pGraphics = GetUI()) 
@@ -132,6 +172,35 @@ void IGEditorDelegate::SendParameterValueFromDelegate(int paramIdx, double value
   IEditorDelegate::SendParameterValueFromDelegate(paramIdx, value, normalized);
 }
 
+void IGEditorDelegate::SendParameterValuesFromDelegate(const int* pParamIdxs, int nParams)
+{
+  if(mGraphics)
+  {
+    std::vector<bool> send(NParams(), false);
+    
+    for (int i = 0; i < nParams; i++)
+      send[pParamIdxs[i]] = true;
+    
+    for (int c = 0; c < mGraphics->NControls(); c++)
+    {
+      IControl* pControl = mGraphics->GetControl(c);
+      
+      int nVals = pControl->NVals();
+      
+      for(int v = 0; v < nVals; v++)
+      {
+        const int paramIdx = pControl->GetParamIdx(v);
+        
+        if (paramIdx > kNoParameter && send[paramIdx])
+          pControl->SetValueFromDelegate(GetParam(paramIdx)->GetNormalized(), v);
+      }
+    }
+  }
+  
+  for (int i = 0; i < nParams; i++)
+    IEditorDelegate::SendParameterValueFromDelegate(pParamIdxs[i], GetParam(pParamIdxs[i])->GetNormalized(), true);
+}
+
 void IGEditorDelegate::SendMidiMsgFromDelegate(const IMidiMsg& msg)
 {
   if(mGraphics)
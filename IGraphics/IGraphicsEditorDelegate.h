@@ -56,6 +56,8 @@ public:
   void SendControlMsgFromDelegate(int ctrlTag, int msgTag, int dataSize = 0, const void* pData = nullptr) override;
   void SendMidiMsgFromDelegate(const IMidiMsg& msg) override;
   void SendParameterValueFromDelegate(int paramIdx, double value, bool normalized) override;
+  /** Updates every control linked to any of the parameters in one pass over the controls, rather than one pass per parameter */
+  void SendParameterValuesFromDelegate(const int* pParamIdxs, int nParams) override;
 
   /** Called to create the IGraphics instance for this editor. Default impl calls  mMakeGraphicsFunc */
   virtual IGraphics* CreateGraphics()
@@ -73,6 +75,18 @@ public:
       mLayoutFunc(pGraphics);
   }
   
+  /** Start decoding a bitmap on a worker thread before the editor is opened, see IGraphics::PreloadBitmap(). Call this in the plug-in's constructor, after mMakeGraphicsFunc is set.
+   * This creates the IGraphics instance, without a window, so that resources are decoded while the host is still setting up. It is kept until OpenWindow() uses it
+   * @param fileNameOrResID CString file name or resource ID, as it will be passed to LoadBitmap()
+   * @param targetScale The scale that LoadBitmap() will ask for, or 0 to follow the screen scale of the window once it is opened */
+  void PreloadBitmap(const char* fileNameOrResID, int targetScale = 0);
+
+  /** Start parsing an SVG on a worker thread before the editor is opened, see PreloadBitmap() and IGraphics::PreloadSVG() */
+  void PreloadSVG(const char* fileNameOrResID, const char* units = "px", float dpi = 72.f);
+
+  /** Start loading a font on a worker thread before the editor is opened, see PreloadBitmap() and IGraphics::PreloadFont() */
+  void PreloadFont(const char* fontID, const char* fileNameOrResID);
+
   /** Get a pointer to the IGraphics context */
   IGraphics* GetUI() { return mGraphics.get(); };
 
@@ -94,7 +108,11 @@ protected:
   std::function<IGraphics*()> mMakeGraphicsFunc = nullptr;
   std::function<void(IGraphics* pGraphics)> mLayoutFunc = nullptr;
 private:
+  /** @return The IGraphics instance that preloads are started on, creating it if there is none */
+  IGraphics* GetPreloadGraphics();
+
   std::unique_ptr<IGraphics> mGraphics;
+  std::unique_ptr<IGraphics> mPreloadGraphics; // created by the Preload methods before the window is opened, adopted by OpenWindow()
   int mLastWidth = 0;
   int mLastHeight = 0;
   float mLastScale = 0.f;
@@ -17,6 +17,14 @@
 
 #include <string>
 #include <memory>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
 
 #include "mutex.h"
 #include "wdlstring.h"
@@ -36,6 +44,8 @@
   #include "modules/svg/include/SkSVGDOM.h"
   #include "include/core/SkCanvas.h"
   #include "include/core/SkStream.h"
+  #include "include/core/SkPicture.h"
+  #include "include/core/SkPictureRecorder.h"
   #include "src/xml/SkDOM.h"
   #pragma warning( pop )
   #pragma comment(lib, "svg.lib")
@@ -456,16 +466,125 @@ protected:
 
 using PlatformFontPtr = std::unique_ptr<PlatformFont>;
 
+/** Used internally to hold an image that has been decoded on a worker thread by IGraphics::PreloadBitmap().
+ * Backends that can create bitmaps off the graphics thread (Skia raster images) fill mAPIBitmap.
+ * Others (NanoVG textures) fill mPixels with RGBA data, which is uploaded on the graphics thread. */
+struct DecodedBitmap
+{
+  std::unique_ptr<APIBitmap> mAPIBitmap;
+  RawBitmapData mPixels;
+  int mWidth = 0;
+  int mHeight = 0;
+  int mScale = 0;
+};
+
+using DecodedBitmapPtr = std::unique_ptr<DecodedBitmap>;
+
+/** Used internally to run resource loading jobs on a small pool of worker threads, see IGraphics::PreloadBitmap() */
+class ResourcePreloader
+{
+public:
+  /** @param nThreads The number of worker threads, if zero this is derived from the hardware concurrency */
+  ResourcePreloader(int nThreads = 0)
+  {
+    if (nThreads <= 0)
+      nThreads = std::max(1, std::min(4, static_cast<int>(std::thread::hardware_concurrency()) - 1));
+    
+    for (int i = 0; i < nThreads; i++)
+      mThreads.emplace_back([this]() { Run(); });
+  }
+  
+  ~ResourcePreloader()
+  {
+    Stop();
+  }
+  
+  ResourcePreloader(const ResourcePreloader&) = delete;
+  ResourcePreloader& operator=(const ResourcePreloader&) = delete;
+  
+  /** Queue a job to run on a worker thread
+   * @param job The job to run
+   * @return A future that will hold the result of the job. If the preloader is stopped before the job runs, the future holds a broken_promise exception */
+  template <class T>
+  std::future<T> Add(std::function<T()> job)
+  {
+    auto pTask = std::make_shared<std::packaged_task<T()>>(std::move(job));
+    std::future<T> result = pTask->get_future();
+    
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mJobs.emplace_back([pTask]() { (*pTask)(); });
+    }
+    
+    mCondition.notify_one();
+    return result;
+  }
+  
+  /** Discard any jobs that have not started, and wait for the running ones to finish */
+  void Stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStop = true;
+      mJobs.clear();
+    }
+    
+    mCondition.notify_all();
+    
+    for (auto& thread : mThreads)
+    {
+      if (thread.joinable())
+        thread.join();
+    }
+    
+    mThreads.clear();
+  }
+  
+private:
+  void Run()
+  {
+    while (true)
+    {
+      std::function<void()> job;
+      
+      {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCondition.wait(lock, [this]() { return mStop || !mJobs.empty(); });
+        
+        if (mStop)
+          return;
+        
+        job = std::move(mJobs.front());
+        mJobs.pop_front();
+      }
+      
+      job();
+    }
+  }
+  
+  std::mutex mMutex;
+  std::condition_variable mCondition;
+  std::deque<std::function<void()>> mJobs;
+  std::vector<std::thread> mThreads;
+  bool mStop = false;
+};
+
 #ifdef SVG_USE_SKIA
 struct SVGHolder
 {
   SVGHolder(sk_sp<SkSVGDOM> svgDom)
   : mSVGDom(svgDom)
   {
+    // Record the DOM once so that drawing replays a flat list of canvas commands rather than walking the DOM
+    SkPictureRecorder recorder;
+    const SkSize size = mSVGDom->containerSize();
+    mSVGDom->render(recorder.beginRecording(SkRect::MakeWH(size.width(), size.height())));
+    mPicture = recorder.finishRecordingAsPicture();
   }
   
   ~SVGHolder()
   {
+    mPicture = nullptr;
     mSVGDom = nullptr;
   }
   
@@ -473,6 +592,7 @@ struct SVGHolder
   SVGHolder& operator=(const SVGHolder&) = delete;
   
   sk_sp<SkSVGDOM> mSVGDom;
+  sk_sp<SkPicture> mPicture;
 };
 #else
 /** Used internally to manage SVG data*/
@@ -495,6 +615,8 @@ struct SVGHolder
   SVGHolder& operator=(const SVGHolder&) = delete;
   
   NSVGimage* mImage = nullptr;
+  /** Winding direction (clockwise == hole) of every path of every shape in document order, precomputed at load time */
+  std::vector<bool> mPathWindings;
 };
 #endif
 
@@ -19,6 +19,9 @@
 #include <functional>
 #include <chrono>
 #include <numeric>
+#include <list>
+#include <unordered_map>
+#include <string_view>
 
 #include "IPlugUtilities.h"
 #include "IPlugLogger.h"
@@ -166,8 +169,9 @@ private:
 #ifdef SVG_USE_SKIA
 struct ISVG
 {
-  ISVG(sk_sp<SkSVGDOM> svgDom)
+  ISVG(sk_sp<SkSVGDOM> svgDom, sk_sp<SkPicture> picture = nullptr)
   : mSVGDom(svgDom)
+  , mPicture(picture)
   {
   }
   
@@ -189,13 +193,16 @@ struct ISVG
   inline bool IsValid() const { return mSVGDom != nullptr; }
   
   sk_sp<SkSVGDOM> mSVGDom;
+  /** A recording of the rendered DOM, shared between instances via the SVG cache */
+  sk_sp<SkPicture> mPicture;
 };
 #else
 struct ISVG
 {  
-  ISVG(NSVGimage* pImage)
+  ISVG(NSVGimage* pImage, const std::vector<bool>* pPathWindings = nullptr)
   {
     mImage = pImage;
+    mPathWindings = pPathWindings;
   }
   
   /** @return The width of the SVG */
@@ -216,6 +223,8 @@ struct ISVG
   inline bool IsValid() const { return mImage != nullptr; }
   
   NSVGimage* mImage = nullptr;
+  /** Precomputed path windings, shared between instances via the SVG cache. If null they are computed when drawing */
+  const std::vector<bool>* mPathWindings = nullptr;
 };
 #endif
 
@@ -2381,14 +2390,16 @@ struct IShadow
    * @param xOffset Offset the shadow horizontally
    * @param yOffset Offset the shadow vertically
    * @param opacity The opacity of the shadow 
-   * @param drawForeground Should the layer contents be drawn, or just the shadow */
-  IShadow(const IPattern& pattern, float blurSize, float xOffset, float yOffset, float opacity, bool drawForeground = true)
+   * @param drawForeground Should the layer contents be drawn, or just the shadow
+   * @param preciseBlur Use a true gaussian convolution, rather than the faster three pass box blur approximation */
+  IShadow(const IPattern& pattern, float blurSize, float xOffset, float yOffset, float opacity, bool drawForeground = true, bool preciseBlur = false)
   : mPattern(pattern)
   , mBlurSize(blurSize)
   , mXOffset(xOffset)
   , mYOffset(yOffset)
   , mOpacity(opacity)
   , mDrawForeground(drawForeground)
+  , mPreciseBlur(preciseBlur)
   {}
   
   IPattern mPattern = COLOR_BLACK;
@@ -2397,6 +2408,134 @@ struct IShadow
   float mYOffset = 0.f;
   float mOpacity = 1.f;
   bool mDrawForeground = true;
+  bool mPreciseBlur = false;
+};
+
+/** A least-recently-used cache of text measurements and backend-specific glyph data, used internally by the drawing backends
+ * so that identical strings (e.g. control value labels) are not re-shaped and re-measured every frame.
+ * Entries are keyed by font, size, alignment, the string itself and the draw scale. Only the members of IText that affect
+ * layout are part of the key, so colors can change without invalidating the cache.
+ * @tparam T The backend-specific data stored per string */
+template <class T>
+class ITextCache
+{
+public:
+  /** Create a text cache
+   * @param maxEntries The number of strings to keep before evicting the least recently used */
+  ITextCache(int maxEntries = 512)
+  : mMaxEntries(maxEntries)
+  {}
+
+  ITextCache(const ITextCache&) = delete;
+  ITextCache& operator=(const ITextCache&) = delete;
+
+  /** Look up a string in the cache, marking it as most recently used
+   * @param text The IText used to draw/measure the string
+   * @param str The string
+   * @param scale The total draw scale
+   * @return Pointer to the cached data, or nullptr if the string is not cached */
+  T* Find(const IText& text, const char* str, double scale)
+  {
+    auto it = mIndex.find(Hash(text, str, scale));
+
+    if (it != mIndex.end() && it->second->Matches(text, str, scale))
+    {
+      mEntries.splice(mEntries.begin(), mEntries, it->second);
+      mHits++;
+      return &it->second->data;
+    }
+
+    mMisses++;
+    return nullptr;
+  }
+
+  /** Add data for a string to the cache, evicting the least recently used entry if the cache is full
+   * @param text The IText used to draw/measure the string
+   * @param str The string
+   * @param scale The total draw scale
+   * @param data The data to store
+   * @return Pointer to the cached data, valid until the entry is evicted or the cache is cleared */
+  T* Add(const IText& text, const char* str, double scale, T&& data)
+  {
+    const size_t hash = Hash(text, str, scale);
+    auto it = mIndex.find(hash);
+
+    // N.B. - on a hash collision the newer entry replaces the older one
+    if (it != mIndex.end())
+    {
+      mEntries.erase(it->second);
+      mIndex.erase(it);
+    }
+    else if (static_cast<int>(mEntries.size()) >= mMaxEntries)
+    {
+      mIndex.erase(mEntries.back().hash);
+      mEntries.pop_back();
+    }
+
+    mEntries.push_front({hash, text.mFont, str, text.mSize, text.mAlign, text.mVAlign, scale, std::move(data)});
+    mIndex[hash] = mEntries.begin();
+
+    return &mEntries.front().data;
+  }
+
+  /** Remove all entries and reset the hit statistics. Called when fonts are loaded or the scale changes */
+  void Clear()
+  {
+    mEntries.clear();
+    mIndex.clear();
+    mHits = 0;
+    mMisses = 0;
+  }
+
+  /** @return The proportion of lookups (0-1) that were served from the cache since it was last cleared */
+  float GetHitRate() const
+  {
+    const uint64_t total = mHits + mMisses;
+    return total ? static_cast<float>(static_cast<double>(mHits) / static_cast<double>(total)) : 0.f;
+  }
+
+  /** @return The number of strings currently cached */
+  int NEntries() const { return static_cast<int>(mEntries.size()); }
+
+private:
+  struct Entry
+  {
+    size_t hash;
+    std::string font;
+    std::string str;
+    float size;
+    EAlign align;
+    EVAlign valign;
+    double scale;
+    T data;
+
+    bool Matches(const IText& text, const char* s, double sc) const
+    {
+      return size == text.mSize && align == text.mAlign && valign == text.mVAlign && scale == sc && font == text.mFont && str == s;
+    }
+  };
+
+  static size_t Hash(const IText& text, const char* str, double scale)
+  {
+    size_t hash = std::hash<std::string_view>()(str);
+
+    auto combine = [&hash](size_t value) {
+      hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    };
+
+    combine(std::hash<std::string_view>()(text.mFont));
+    combine(std::hash<float>()(text.mSize));
+    combine(static_cast<size_t>(text.mAlign) | (static_cast<size_t>(text.mVAlign) << 4));
+    combine(std::hash<double>()(scale));
+
+    return hash;
+  }
+
+  int mMaxEntries;
+  uint64_t mHits = 0;
+  uint64_t mMisses = 0;
+  std::list<Entry> mEntries;
+  std::unordered_map<size_t, typename std::list<Entry>::iterator> mIndex;
 };
 
 /** Contains a set of 9 colors used to theme IVControls */
@@ -289,6 +289,7 @@ void IPlugAAX::RenderAudio(AAX_SIPlugRenderInfo* pRenderInfo, const TParamValPai
   if (numSamples > GetBlockSize())
   {
     SetBlockSize(numSamples);
+    PrepareParamSmoothing(numSamples);
     OnReset();
   }
 
@@ -362,6 +363,7 @@ void IPlugAAX::RenderAudio(AAX_SIPlugRenderInfo* pRenderInfo, const TParamValPai
     }
     
     ENTER_PARAMS_MUTEX
+    ProcessParamSmoothing(GetSampleRate(), numSamples);
     ProcessBuffers(0.0f, numSamples);
     LEAVE_PARAMS_MUTEX
   }
@@ -502,8 +504,16 @@ AAX_Result IPlugAAX::SetChunk(AAX_CTypeID chunkID, const AAX_SPlugInChunk* pChun
     //IByteChunk::GetIPlugVerFromChunk(chunk, pos); // TODO: IPlugVer should be in chunk!
     pos = UnserializeState(chunk, pos);
     
-    for (int i = 0; i< NParams(); i++)
-      SetParameterNormalizedValue(mParamIDs.Get(i)->Get(), GetParam(i)->GetNormalized());
+    if (GetParamsRecalledInBulk())
+    {
+      for (int paramIdx : GetLastChangedParams())
+        SetParameterNormalizedValue(mParamIDs.Get(paramIdx)->Get(), GetParam(paramIdx)->GetNormalized());
+    }
+    else
+    {
+      for (int i = 0; i< NParams(); i++)
+        SetParameterNormalizedValue(mParamIDs.Get(i)->Get(), GetParam(i)->GetNormalized());
+    }
     
     OnRestoreState();
     mNumPlugInChanges++; // necessary in order to cause CompareActiveChunk() to get called again and turn off the compare light 
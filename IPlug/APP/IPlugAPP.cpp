@@ -167,6 +167,7 @@ void IPlugAPP::AppProcess(double** inputs, double** outputs, int nFrames)
   //Do not handle Sysex messages here - SendSysexMsgFromUI overridden
 
   ENTER_PARAMS_MUTEX
+  ProcessParamSmoothing(GetSampleRate(), GetBlockSize());
   ProcessBuffers(0.0, GetBlockSize());
   LEAVE_PARAMS_MUTEX
 }
@@ -612,6 +612,7 @@ bool IPlugAPPHost::InitAudio(uint32_t inID, uint32_t outID, uint32_t sr, uint32_
   mAudioDone = false;
   
   mIPlug->SetBlockSize(APP_SIGNAL_VECTOR_SIZE);
+  mIPlug->PrepareParamSmoothing(APP_SIGNAL_VECTOR_SIZE);
   mIPlug->SetSampleRate(mSampleRate);
   mIPlug->OnReset();
 
@@ -1218,6 +1218,7 @@ OSStatus IPlugAU::SetProperty(AudioUnitPropertyID propID, AudioUnitScope scope,
     case kAudioUnitProperty_MaximumFramesPerSlice:       // 14,
     {
       SetBlockSize(*((UInt32*) pData));
+      PrepareParamSmoothing(*((UInt32*) pData));
       ResizeScratchBuffers();
       OnReset();
       return noErr;
@@ -1755,6 +1756,7 @@ OSStatus IPlugAU::RenderProc(void* pPlug, AudioUnitRenderActionFlags* pFlags, co
       
       _this->PreProcess();
       ENTER_PARAMS_MUTEX_STATIC
+      _this->ProcessParamSmoothing(_this->GetSampleRate(), nFrames);
       _this->ProcessBuffers((AudioSampleType) 0, nFrames);
       LEAVE_PARAMS_MUTEX_STATIC
     }
@@ -181,6 +181,7 @@ void IPlugAUv3::ProcessWithEvents(AudioTimeStamp const* pTimestamp, uint32_t fra
   }
 
   ENTER_PARAMS_MUTEX;
+  ProcessParamSmoothing(GetSampleRate(), framesRemaining);
   ProcessBuffers(0.f, framesRemaining); // what about bufferOffset
   LEAVE_PARAMS_MUTEX;
     
@@ -322,5 +323,6 @@ void IPlugAUv3::Prepare(double sampleRate, uint32_t blockSize)
   SetChannelConnections(ERoute::kInput, 0, MaxNChannels(ERoute::kInput), false);
   SetChannelConnections(ERoute::kOutput, 0, MaxNChannels(ERoute::kOutput), false);
   SetBlockSize(blockSize);
+  PrepareParamSmoothing(blockSize);
   SetSampleRate(sampleRate);
 }
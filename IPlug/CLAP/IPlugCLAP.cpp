@@ -154,6 +154,7 @@ bool IPlugCLAP::init() noexcept
 bool IPlugCLAP::activate(double sampleRate, uint32_t minFrameCount, uint32_t maxFrameCount) noexcept
 {
   SetBlockSize(maxFrameCount);
+  PrepareParamSmoothing(maxFrameCount);
   SetSampleRate(sampleRate);
   OnActivate(true);
   OnParamReset(kReset);
@@ -253,8 +254,7 @@ clap_process_status IPlugCLAP::process(const clap_process* pProcess) noexcept
   int nOuts = 0;
   int nFrames = pProcess->frames_count;
   
-  // Local tail handling
-  bool localTail = !mHostHasTail && !GetTailIsInfinite() && GetTailSize();
+  // Local tail handling needs to know if all of the inputs are silent
   bool insQuiet = true;
   
   // Sum IO channels
@@ -303,10 +303,12 @@ clap_process_status IPlugCLAP::process(const clap_process* pProcess) noexcept
         {
           mAudioIO64.Get()[k] = bus.data64[j];
           
-          // For local tail processing check for non-zero inputs
-
-          if (localTail && insQuiet)
-            insQuiet = InputIsSilent(bus.data64[j], nFrames);
+          // Channels the host marks as constant only need their first sample checking, others are scanned for non-zero inputs.
+          // Each channel is checked on its own, so its flag doesn't depend on the channels before it
+          const bool silent = (j < 64 && (bus.constant_mask >> j) & 1) ? bus.data64[j][0] == 0 : InputIsSilent(bus.data64[j], nFrames);
+          
+          SetInputSilent(k, silent);
+          insQuiet &= silent;
         }
       }
       
@@ -322,9 +324,12 @@ clap_process_status IPlugCLAP::process(const clap_process* pProcess) noexcept
         {
           mAudioIO32.Get()[k] = bus.data32[j];
           
-          // For local tail processing check for non-zero inputs
-          if (localTail && insQuiet)
-            insQuiet = InputIsSilent(bus.data32[j], nFrames);
+          // Channels the host marks as constant only need their first sample checking, others are scanned for non-zero inputs.
+          // Each channel is checked on its own, so its flag doesn't depend on the channels before it
+          const bool silent = (j < 64 && (bus.constant_mask >> j) & 1) ? bus.data32[j][0] == 0 : InputIsSilent(bus.data32[j], nFrames);
+          
+          SetInputSilent(k, silent);
+          insQuiet &= silent;
         }
       }
       
@@ -362,11 +367,26 @@ clap_process_status IPlugCLAP::process(const clap_process* pProcess) noexcept
     }
   }
 
+  ProcessParamSmoothing(GetSampleRate(), nFrames);
+
   if (format64)
     ProcessBuffers(0.0, nFrames);
   else
     ProcessBuffers(0.f, nFrames);
     
+  // Report silent outputs to the host
+  for (uint32_t i = 0, k = 0; i < pProcess->audio_outputs_count; i++)
+  {
+    clap_audio_buffer_t& bus = pProcess->audio_outputs[i];
+    bus.constant_mask = 0;
+    
+    for (uint32_t j = 0; j < bus.channel_count; j++, k++)
+    {
+      if (j < 64 && IsChannelSilent(ERoute::kOutput, k))
+        bus.constant_mask |= static_cast<uint64_t>(1) << j;
+    }
+  }
+  
   // Send Events Out (Parameters and MIDI)
   ProcessOutputEvents(pProcess->out_events, nFrames);
   
@@ -377,6 +397,10 @@ clap_process_status IPlugCLAP::process(const clap_process* pProcess) noexcept
     mTailUpdate = false;
   }
   
+  // No processing is needed until the input changes
+  if (IsSleeping())
+    return CLAP_PROCESS_SLEEP;
+  
   // Local tail handling
   if (mHostHasTail)
     return CLAP_PROCESS_TAIL;
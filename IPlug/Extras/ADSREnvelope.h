@@ -298,6 +298,155 @@ public:
     return mPrevOutput;
   }
 
+  /** Process a block of the envelope, producing exactly the same output as calling Process() for every sample.
+   * The stage is only examined at segment boundaries, each segment is rendered in a tight loop for its stage, and the constant stages and velocity scaling are filled in loops that can be vectorized.
+   * @param pOutput Buffer of nFrames samples to write the envelope to
+   * @param nFrames The number of samples to process
+   * @param sustainLevel The sustain level for the whole block */
+  void ProcessBlock(T* pOutput, int nFrames, T sustainLevel = 0.)
+  {
+    int s = 0;
+
+    while (s < nFrames)
+    {
+      const int start = s;
+      const T level = mLevel;
+      T result = mPrevResult;
+
+      switch(mStage)
+      {
+        case kAttack:
+        {
+          const T incr = mAttackIncr * mScalar;
+
+          while (s < nFrames)
+          {
+            mEnvValue += incr;
+            const bool end = mEnvValue > ENV_VALUE_HIGH || mAttackIncr == 0.;
+            if (end)
+            {
+              mStage = kDecay;
+              mEnvValue = 1.;
+            }
+            result = pOutput[s++] = mEnvValue;
+            if (end)
+              break;
+          }
+          break;
+        }
+        case kDecay:
+        {
+          while (s < nFrames)
+          {
+            mEnvValue -= ((mDecayIncr*mEnvValue) * mScalar);
+            T value = (mEnvValue * (1.-sustainLevel)) + sustainLevel;
+            const bool end = mEnvValue < ENV_VALUE_LOW;
+            if (end)
+            {
+              if(mSustainEnabled)
+              {
+                mStage = kSustain;
+                mEnvValue = 1.;
+                value = sustainLevel;
+              }
+              else
+              {
+                mPrevResult = result;
+                Release();
+              }
+            }
+            result = pOutput[s++] = value;
+            if (end)
+              break;
+          }
+          break;
+        }
+        case kRelease:
+        {
+          while (s < nFrames)
+          {
+            mEnvValue -= ((mReleaseIncr*mEnvValue) * mScalar);
+            const bool end = mEnvValue < ENV_VALUE_LOW || mReleaseIncr == 0.;
+            if (end)
+            {
+              mStage = kIdle;
+              mEnvValue = 0.;
+              
+              if(mEndReleaseFunc)
+                mEndReleaseFunc();
+            }
+            result = pOutput[s++] = mEnvValue * mReleaseLevel;
+            if (end)
+              break;
+          }
+          break;
+        }
+        case kReleasedToRetrigger:
+        {
+          while (s < nFrames)
+          {
+            mEnvValue -= mRetriggerReleaseIncr;
+            const bool end = mEnvValue < ENV_VALUE_LOW;
+            if (end)
+            {
+              mStage = kAttack;
+              mLevel = mNewStartLevel;
+              mEnvValue = 0.;
+              mPrevResult = 0.;
+              mReleaseLevel = 0.;
+              
+              if(mResetFunc)
+                mResetFunc();
+            }
+            result = pOutput[s++] = mEnvValue * mReleaseLevel;
+            if (end)
+              break;
+          }
+          break;
+        }
+        case kReleasedToEndEarly:
+        {
+          while (s < nFrames)
+          {
+            mEnvValue -= mEarlyReleaseIncr;
+            const bool end = mEnvValue < ENV_VALUE_LOW;
+            if (end)
+            {
+              mStage = kIdle;
+              mLevel = 0.;
+              mEnvValue = 0.;
+              mPrevResult = 0.;
+              mReleaseLevel = 0.;
+              if(mEndReleaseFunc)
+                mEndReleaseFunc();
+            }
+            result = pOutput[s++] = mEnvValue * mReleaseLevel;
+            if (end)
+              break;
+          }
+          break;
+        }
+        default: // kIdle, kSustain: constant until the envelope is next triggered or released
+        {
+          result = mStage == kSustain ? sustainLevel : mEnvValue;
+          
+          for (; s < nFrames; s++)
+            pOutput[s] = result;
+          break;
+        }
+      }
+
+      mPrevResult = result;
+      
+      // Apply the velocity level. The last sample of a segment uses the level after any stage transition, as Process() does
+      for (int i = start; i < s - 1; i++)
+        pOutput[i] *= level;
+      
+      pOutput[s - 1] *= mLevel;
+      mPrevOutput = pOutput[s - 1];
+    }
+  }
+
 private:
   inline T CalcIncrFromTimeLinear(T timeMS, T sr) const
   {
@@ -0,0 +1,464 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @brief Convolution with a WDL_ConvolutionEngine whose impulse response is prepared on a worker thread, and swapped in with a short crossfade
+ *
+ * Resampling a long impulse response and building its FFT partitions (WDL_ConvolutionEngine::SetImpulse()) can take much longer than an audio block.
+ * AsyncConvolver does both on a worker thread, in a new engine, which is handed to the audio thread with a single atomic exchange.
+ * The audio thread keeps running the previous engine until the new one produces output, then crossfades between them, so changing the impulse response
+ * or the sample rate never blocks and never clicks:
+ *
+ * // constructor
+ * mConvolver.SetImpulse(&pIR, 1, irLength, 44100.);
+ * // OnReset()
+ * mConvolver.SetSampleRate(GetSampleRate());
+ * // ProcessBlock()
+ * mConvolver.ProcessBlock(inputs, outputs, nFrames, dryGain, wetGain);
+ *
+ * Every engine uses the same FFT size, so the latency is fixed at GetLatency(). Resampled impulse responses are shared with SharedAssets between instances that use the same resampler.
+ * A custom resampler must be given an ID for its impulse responses to be shared, as a lambda has no identity of its own:
+ *
+ * AsyncConvolver mConvolver {1, 1024, [this](...) { ... }, "my-sinc"};
+ * NOTE: WDL/convoengine.cpp and WDL/fft.c must be compiled into the project, and WDL_FFT_REALSIZE must match the sample type passed to ProcessBlock()
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "IPlugPlatform.h"
+#include "IPlugQueue.h"
+#include "SharedAssets.h"
+#include "convoengine.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+class AsyncConvolver
+{
+public:
+  /** Resamples one channel of an impulse response. Called on the worker thread
+   * @param pSrc srcLength samples at srcRate
+   * @param pDst dstLength samples to fill at dstRate */
+  using ResampleFunc = std::function<void(const WDL_FFT_REAL* pSrc, int srcLength, double srcRate, WDL_FFT_REAL* pDst, int dstLength, double dstRate)>;
+
+  /** @param nChans The number of input and output channels
+   * @param fftSize The FFT size of every engine, a power of two. The latency is half of this, and larger sizes are cheaper for long impulse responses
+   * @param resampleFunc The resampler, or nullptr for linear interpolation
+   * @param resamplerID A name for resampleFunc, which is part of the key of the shared impulse responses, so that only instances using the same resampler share them.
+   * If resampleFunc is given without an ID, its impulse responses are not shared with other instances */
+  AsyncConvolver(int nChans = 1, int fftSize = 1024, ResampleFunc resampleFunc = nullptr, const char* resamplerID = nullptr)
+  : mNChans(nChans)
+  , mFFTSize(fftSize)
+  , mResampleFunc(resampleFunc ? resampleFunc : ResampleLinear)
+  , mRetired(kQueueSize)
+  , mInputPtrs(nChans)
+  , mOutputPtrs(nChans)
+  {
+    assert(fftSize >= 32 && !(fftSize & (fftSize - 1)) && "fftSize must be a power of two");
+
+    if (!resampleFunc)
+      resamplerID = "linear";
+
+    if (resamplerID)
+      mResamplerHash = SharedAssets::HashContent(resamplerID, strlen(resamplerID));
+    else
+    {
+      const AsyncConvolver* pThis = this;
+      mResamplerHash = SharedAssets::HashContent(&pThis, sizeof(pThis));
+    }
+
+    // The FFT tables are built on first use, which must not happen on several workers at once
+    WDL_fft_init();
+  }
+
+  ~AsyncConvolver()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mQuit = true;
+    }
+
+    mCondition.notify_one();
+
+    if (mWorker.joinable())
+      mWorker.join();
+
+    FreeRetiredEngines();
+    delete mReady.exchange(nullptr);
+    delete mActive;
+    delete mFading;
+  }
+
+  AsyncConvolver(const AsyncConvolver&) = delete;
+  AsyncConvolver& operator=(const AsyncConvolver&) = delete;
+
+  /** Set the impulse response. The data is copied, and prepared on the worker once a sample rate is set. Call this on the main thread
+   * @param pChannels nChans pointers to length samples. If there are fewer channels than the convolver has, they are repeated
+   * @param nChans The number of channels in the impulse response
+   * @param length The length of the impulse response in samples
+   * @param sampleRate The sample rate of the impulse response */
+  template <typename I>
+  void SetImpulse(const I* const* pChannels, int nChans, int length, double sampleRate)
+  {
+    std::shared_ptr<Source> source(new Source);
+    source->sampleRate = sampleRate;
+    source->length = length;
+    source->channels.resize(nChans);
+
+    for (auto c = 0; c < nChans; c++)
+      source->channels[c].assign(pChannels[c], pChannels[c] + length);
+
+    PostRequest([&](Request& request) { request.source = source; });
+  }
+
+  /** Set the sample rate to prepare the impulse response for, e.g. from OnReset(). The current engine keeps running until the new one is ready */
+  void SetSampleRate(double sampleRate)
+  {
+    PostRequest([&](Request& request) { request.sampleRate = sampleRate; });
+  }
+
+  /** Set the length of the crossfade between the previous and the new impulse response. This applies to impulse responses prepared afterwards
+   * @param timeMs The crossfade time in milliseconds */
+  void SetCrossfadeTime(double timeMs)
+  {
+    PostRequest([&](Request& request) { request.crossfadeMs = timeMs; }, false);
+  }
+
+  /** @return The latency in samples, which is the same for every impulse response */
+  int GetLatency() const { return mFFTSize / 2; }
+
+  /** Convolve a block, mixing the dry input with the convolved signal. This is realtime safe, call it from ProcessBlock().
+   * Until the first impulse response is ready only the dry signal is output. Inputs and outputs may be the same buffers
+   * @param inputs nChans input channels
+   * @param outputs nChans output channels
+   * @param nFrames The number of frames in the block
+   * @param dryGain The gain of the input
+   * @param wetGain The gain of the convolved signal */
+  void ProcessBlock(WDL_FFT_REAL** inputs, WDL_FFT_REAL** outputs, int nFrames, WDL_FFT_REAL dryGain = 0., WDL_FFT_REAL wetGain = 1.)
+  {
+    // Blocks longer than the FFT size are split, so that the engines' buffers never grow beyond what Prepare() allocated
+    for (auto start = 0; start < nFrames; start += mFFTSize)
+    {
+      for (auto c = 0; c < mNChans; c++)
+      {
+        mInputPtrs[c] = inputs[c] + start;
+        mOutputPtrs[c] = outputs[c] + start;
+      }
+
+      ProcessChunk(mInputPtrs.data(), mOutputPtrs.data(), std::min(mFFTSize, nFrames - start), dryGain, wetGain);
+    }
+  }
+
+private:
+  static constexpr int kQueueSize = 8;
+  static constexpr int kFreeIntervalMs = 250;
+
+  /** Convolve at most mFFTSize frames, see ProcessBlock() */
+  void ProcessChunk(WDL_FFT_REAL** inputs, WDL_FFT_REAL** outputs, int nFrames, WDL_FFT_REAL dryGain, WDL_FFT_REAL wetGain)
+  {
+    ReceiveEngine();
+
+    if (!mActive)
+    {
+      for (auto c = 0; c < mNChans; c++)
+      {
+        for (auto s = 0; s < nFrames; s++)
+          outputs[c][s] = dryGain * inputs[c][s];
+      }
+
+      return;
+    }
+
+    // Each engine's output is placed so that it lags its input by exactly the latency, so the engines line up whenever they started
+    const int activeStart = Convolve(*mActive, inputs, nFrames);
+    const int fadingStart = mFading ? Convolve(*mFading, inputs, nFrames) : nFrames;
+    WDL_FFT_REAL** pActiveOut = mActive->engine.Get();
+    WDL_FFT_REAL** pFadingOut = mFading ? mFading->engine.Get() : nullptr;
+
+    for (auto c = 0; c < mNChans; c++)
+    {
+      const WDL_FFT_REAL* pIn = inputs[c];
+      WDL_FFT_REAL* pOut = outputs[c];
+      const WDL_FFT_REAL* pActive = pActiveOut[c] - activeStart;
+
+      if (!mFading)
+      {
+        for (auto s = 0; s < nFrames; s++)
+          pOut[s] = dryGain * pIn[s] + (s >= activeStart ? wetGain * pActive[s] : 0);
+
+        continue;
+      }
+
+      // The crossfade starts when the new engine produces output, until then the previous engine plays alone
+      const WDL_FFT_REAL* pFading = pFadingOut[c] - fadingStart;
+      const WDL_FFT_REAL fadeIncr = static_cast<WDL_FFT_REAL>(1) / mActive->crossfadeSamples;
+      int fadePos = mFadePos;
+
+      for (auto s = 0; s < nFrames; s++)
+      {
+        const WDL_FFT_REAL gain = s >= activeStart ? std::min(static_cast<WDL_FFT_REAL>(fadePos++) * fadeIncr, static_cast<WDL_FFT_REAL>(1)) : 0;
+        const WDL_FFT_REAL active = s >= activeStart ? pActive[s] : 0;
+        const WDL_FFT_REAL fading = s >= fadingStart ? pFading[s] : 0;
+        pOut[s] = dryGain * pIn[s] + wetGain * (fading + gain * (active - fading));
+      }
+    }
+
+    mActive->Advance(nFrames - activeStart);
+
+    if (mFading)
+    {
+      mFading->Advance(nFrames - fadingStart);
+      mFadePos += nFrames - activeStart;
+
+      // If the worker has not freed earlier engines yet, the faded out engine keeps running silently, and is retired on a later block
+      if (mFadePos >= mActive->crossfadeSamples && mRetired.Push(mFading))
+        mFading = nullptr;
+    }
+  }
+
+  /** The impulse response as supplied, before resampling */
+  struct Source
+  {
+    std::vector<std::vector<WDL_FFT_REAL>> channels;
+    int length = 0;
+    double sampleRate = 0.;
+  };
+
+  /** The impulse response resampled for one sample rate, which is shared between instances */
+  struct Resampled
+  {
+    WDL_ImpulseBuffer impulse;
+  };
+
+  /** An engine with its partitioned impulse response, built on the worker and then only used on the audio thread */
+  struct Engine
+  {
+    WDL_ConvolutionEngine engine;
+    std::shared_ptr<const Resampled> resampled;
+    int crossfadeSamples = 1;
+    int64_t nInput = 0;
+    int64_t nOutput = 0;
+
+    void Advance(int n)
+    {
+      engine.Advance(n);
+      nOutput += n;
+    }
+  };
+
+  struct Request
+  {
+    std::shared_ptr<const Source> source;
+    double sampleRate = 0.;
+    double crossfadeMs = 20.;
+  };
+
+  static void ResampleLinear(const WDL_FFT_REAL* pSrc, int srcLength, double srcRate, WDL_FFT_REAL* pDst, int dstLength, double dstRate)
+  {
+    const double delta = srcRate / dstRate;
+
+    for (auto i = 0; i < dstLength; i++)
+    {
+      const double pos = i * delta;
+      const int idx = static_cast<int>(pos);
+      const double frac = pos - idx;
+      const double a = idx < srcLength ? pSrc[idx] : 0.;
+      const double b = idx + 1 < srcLength ? pSrc[idx + 1] : 0.;
+      pDst[i] = static_cast<WDL_FFT_REAL>(delta * (a + frac * (b - a)));
+    }
+  }
+
+  /** Add a block to an engine, and get the output that is due
+   * @return The frame in the block at which the engine's output starts */
+  int Convolve(Engine& engine, WDL_FFT_REAL** inputs, int nFrames)
+  {
+    engine.engine.Add(inputs, nFrames, mNChans);
+    engine.nInput += nFrames;
+
+    const int due = static_cast<int>(std::max<int64_t>(engine.nInput - GetLatency() - engine.nOutput, 0));
+    const int n = std::min(engine.engine.Avail(due), due);
+    return nFrames - n;
+  }
+
+  /** Take the newest engine from the worker. The active engine starts fading out, and one that was still fading out is retired.
+   * Freeing an engine could block, so it is handed back to the worker. If there is no room for it, the swap waits for a later block */
+  void ReceiveEngine()
+  {
+    if (!mReady.load())
+      return;
+
+    if (mFading)
+    {
+      if (!mRetired.Push(mFading))
+        return;
+
+      mFading = nullptr;
+    }
+
+    mFading = mActive;
+    mActive = mReady.exchange(nullptr);
+    mFadePos = 0;
+  }
+
+  void FreeRetiredEngines()
+  {
+    Engine* pEngine = nullptr;
+
+    while (mRetired.Pop(pEngine))
+      delete pEngine;
+  }
+
+  /** Update the request and wake the worker, which prepares an engine if there is an impulse response and a sample rate */
+  template <typename F>
+  void PostRequest(F updateFunc, bool prepare = true)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      updateFunc(mRequest);
+
+      if (!prepare)
+        return;
+
+      mRequestPending = true;
+
+      if (!mWorker.joinable())
+        mWorker = std::thread([this]() { WorkerLoop(); });
+    }
+
+    mCondition.notify_one();
+  }
+
+  void WorkerLoop()
+  {
+    while (true)
+    {
+      Request request;
+
+      {
+        std::unique_lock<std::mutex> lock(mMutex);
+        // Wake up now and then to free the engines that the audio thread has finished with
+        mCondition.wait_for(lock, std::chrono::milliseconds(kFreeIntervalMs), [this]() { return mRequestPending || mQuit; });
+
+        if (mQuit)
+          return;
+
+        if (mRequestPending)
+          request = mRequest;
+
+        mRequestPending = false;
+      }
+
+      FreeRetiredEngines();
+
+      if (!request.source || request.sampleRate <= 0.)
+        continue;
+
+      // An engine that the audio thread has not taken yet is replaced, only the newest is wanted
+      if (Engine* pEngine = Prepare(request))
+        delete mReady.exchange(pEngine);
+    }
+  }
+
+  /** Resample the impulse response, or get it from another instance, and build a new engine's FFT partitions */
+  Engine* Prepare(const Request& request)
+  {
+    const Source& source = *request.source;
+    const int nChans = static_cast<int>(source.channels.size());
+
+    if (!nChans || source.length <= 0)
+      return nullptr;
+
+    uint64_t hash = SharedAssets::HashContent(&source.sampleRate, sizeof(source.sampleRate), mResamplerHash);
+
+    for (const auto& channel : source.channels)
+      hash = SharedAssets::HashContent(channel.data(), channel.size() * sizeof(WDL_FFT_REAL), hash);
+
+    std::shared_ptr<const Resampled> resampled = SharedAssets::Get<Resampled>(hash, request.sampleRate, [&]() {
+      std::unique_ptr<Resampled> pResampled(new Resampled);
+      WDL_ImpulseBuffer& impulse = pResampled->impulse;
+      const int length = static_cast<int>(request.sampleRate / source.sampleRate * source.length + 0.5);
+
+      impulse.samplerate = request.sampleRate;
+      impulse.SetNumChannels(nChans, false);
+
+      if (impulse.SetLength(length) != length)
+        return std::unique_ptr<Resampled>();
+
+      for (auto c = 0; c < nChans; c++)
+      {
+        if (length == source.length)
+          std::copy(source.channels[c].begin(), source.channels[c].end(), impulse.impulses[c].Get());
+        else
+          mResampleFunc(source.channels[c].data(), source.length, source.sampleRate, impulse.impulses[c].Get(), length, request.sampleRate);
+      }
+
+      return pResampled;
+    });
+
+    if (!resampled)
+      return nullptr;
+
+    std::unique_ptr<Engine> pEngine(new Engine);
+    pEngine->resampled = resampled;
+    pEngine->crossfadeSamples = std::max(static_cast<int>(request.crossfadeMs * 0.001 * request.sampleRate), 1);
+
+    // SetImpulse() copies the impulse response into the engine's partitions and doesn't modify it
+    pEngine->engine.SetImpulse(const_cast<WDL_ImpulseBuffer*>(&resampled->impulse), mFFTSize);
+
+    // Run silence through the engine, so that its buffers are allocated here rather than on the audio thread. ProcessBlock() adds at most mFFTSize frames at a time,
+    // on top of less than mFFTSize frames that are still queued, so twice that is enough
+    std::vector<WDL_FFT_REAL> silence(mFFTSize * 2);
+    std::vector<WDL_FFT_REAL*> silenceChans(mNChans, silence.data());
+    pEngine->engine.Add(silenceChans.data(), mFFTSize * 2, mNChans);
+    pEngine->engine.Avail(mFFTSize * 2);
+    pEngine->engine.Reset();
+
+    return pEngine.release();
+  }
+
+  const int mNChans;
+  const int mFFTSize;
+  const ResampleFunc mResampleFunc;
+  /** Seeds the content hash of the shared impulse responses */
+  uint64_t mResamplerHash = 0;
+
+  std::thread mWorker;
+  std::mutex mMutex;
+  std::condition_variable mCondition;
+  Request mRequest;
+  bool mRequestPending = false;
+  bool mQuit = false;
+
+  /** The newest prepared engine, owned by whoever exchanges it out */
+  std::atomic<Engine*> mReady {nullptr};
+  /** Engines the audio thread has finished with, freed by the worker */
+  IPlugQueue<Engine*> mRetired;
+
+  // Only used on the audio thread
+  Engine* mActive = nullptr;
+  Engine* mFading = nullptr;
+  int mFadePos = 0;
+  std::vector<WDL_FFT_REAL*> mInputPtrs;
+  std::vector<WDL_FFT_REAL*> mOutputPtrs;
+};
+
+END_IPLUG_NAMESPACE
@@ -0,0 +1,222 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @brief Header-only combinators to run Extras DSP classes serially or in parallel, without type erasure
+ *
+ * Any object with a method ProcessBlock(T** inputs, T** outputs, int nChans, int nFrames) that can process in place
+ * (e.g. SVF, DCBlocker) can be a stage. Other callables can be adapted with MakeBlockStage() or MakeSampleStage().
+ * Chains are stages themselves, so they nest, and they can be passed directly to OverSampler::ProcessBlock() or RealtimeResampler::ProcessBlock():
+ *
+ * auto gate = MakeBlockStage<sample>([&](sample** in, sample** out, int nChans, int nFrames) { mGate.ProcessBlock(in, out, in[0], nChans, nFrames); });
+ * auto chain = MakeSerialChain<sample, 2>(mDCBlocker, mSVF, gate);
+ * mOverSampler.ProcessBlock(inputs, outputs, nFrames, 2, 2, chain);
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+#include <utility>
+
+#include "IPlugPlatform.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+/** Adapts a callable with the signature void(T** inputs, T** outputs, int nChans, int nFrames) to a stage */
+template <typename T, typename F>
+class BlockStage
+{
+public:
+  BlockStage(F func)
+  : mFunc(std::move(func))
+  {
+  }
+
+  inline void ProcessBlock(T** inputs, T** outputs, int nChans, int nFrames)
+  {
+    mFunc(inputs, outputs, nChans, nFrames);
+  }
+
+private:
+  F mFunc;
+};
+
+/** Adapts a per-sample callable with the signature T(T) to a stage, which applies it to every sample of every channel */
+template <typename T, typename F>
+class SampleStage
+{
+public:
+  SampleStage(F func)
+  : mFunc(std::move(func))
+  {
+  }
+
+  inline void ProcessBlock(T** inputs, T** outputs, int nChans, int nFrames)
+  {
+    for (auto c = 0; c < nChans; c++)
+    {
+      for (auto s = 0; s < nFrames; s++)
+      {
+        outputs[c][s] = mFunc(inputs[c][s]);
+      }
+    }
+  }
+
+private:
+  F mFunc;
+};
+
+/** Base for the chains, which splits blocks into tiles and provides the call signatures used by OverSampler and RealtimeResampler
+ * @tparam T the sample type
+ * @tparam NC the maximum number of channels
+ * @tparam DERIVED the chain class, which implements ProcessTile() */
+template <typename T, int NC, typename DERIVED>
+class DSPChainBase
+{
+public:
+  /** The number of frames each stage processes before the next stage runs, small enough that intermediate results stay in L1 cache */
+  static constexpr int kTileSize = 64;
+
+  void ProcessBlock(T** inputs, T** outputs, int nChans, int nFrames)
+  {
+    assert(nChans <= NC);
+
+    T* tileInputs[NC];
+    T* tileOutputs[NC];
+
+    for (auto start = 0; start < nFrames; start += kTileSize)
+    {
+      const int tileFrames = std::min(kTileSize, nFrames - start);
+
+      for (auto c = 0; c < nChans; c++)
+      {
+        tileInputs[c] = inputs[c] + start;
+        tileOutputs[c] = outputs[c] + start;
+      }
+
+      static_cast<DERIVED*>(this)->ProcessTile(tileInputs, tileOutputs, nChans, tileFrames);
+    }
+  }
+
+  /** Process all NC channels, matching the function signature of OverSampler::ProcessBlock() */
+  inline void operator()(T** inputs, T** outputs, int nFrames)
+  {
+    ProcessBlock(inputs, outputs, NC, nFrames);
+  }
+
+  /** Matches the function signature of RealtimeResampler::ProcessBlock() */
+  inline void operator()(T** inputs, T** outputs, int nFrames, int nChans)
+  {
+    ProcessBlock(inputs, outputs, nChans, nFrames);
+  }
+};
+
+/** Runs stages one after another. Each block is processed a tile at a time, every stage processing the tile before the next tile is started,
+ * so that intermediate results stay in cache rather than being streamed through memory once per stage.
+ * Stages are held by reference and must support in-place processing. */
+template <typename T, int NC, typename... Stages>
+class SerialChain : public DSPChainBase<T, NC, SerialChain<T, NC, Stages...>>
+{
+public:
+  SerialChain(Stages&... stages)
+  : mStages(stages...)
+  {
+  }
+
+  inline void ProcessTile(T** inputs, T** outputs, int nChans, int nFrames)
+  {
+    ProcessStages(inputs, outputs, nChans, nFrames, std::index_sequence_for<Stages...>());
+  }
+
+private:
+  template <size_t... Is>
+  inline void ProcessStages(T** inputs, T** outputs, int nChans, int nFrames, std::index_sequence<Is...>)
+  {
+    // The first stage reads the input, the rest process the output in place
+    (std::get<Is>(mStages).ProcessBlock(Is == 0 ? inputs : outputs, outputs, nChans, nFrames), ...);
+  }
+
+  std::tuple<Stages&...> mStages;
+};
+
+/** Runs stages side by side on the same input and sums their outputs. Each block is processed a tile at a time, using fixed size scratch buffers, so no memory is allocated.
+ * Stages are held by reference. The input and output buffers may be the same. */
+template <typename T, int NC, typename... Stages>
+class ParallelChain : public DSPChainBase<T, NC, ParallelChain<T, NC, Stages...>>
+{
+  using Base = DSPChainBase<T, NC, ParallelChain<T, NC, Stages...>>;
+
+public:
+  ParallelChain(Stages&... stages)
+  : mStages(stages...)
+  {
+  }
+
+  inline void ProcessTile(T** inputs, T** outputs, int nChans, int nFrames)
+  {
+    T* tileInputs[NC];
+    T* tileScratch[NC];
+
+    // Copy the input, so that every stage sees it even when processing in place
+    for (auto c = 0; c < nChans; c++)
+    {
+      tileInputs[c] = mInput[c];
+      tileScratch[c] = mScratch[c];
+      memcpy(mInput[c], inputs[c], nFrames * sizeof(T));
+      std::fill(outputs[c], outputs[c] + nFrames, T(0));
+    }
+
+    ProcessStages(tileInputs, tileScratch, outputs, nChans, nFrames, std::index_sequence_for<Stages...>());
+  }
+
+private:
+  template <size_t... Is>
+  inline void ProcessStages(T** inputs, T** scratch, T** outputs, int nChans, int nFrames, std::index_sequence<Is...>)
+  {
+    auto processStage = [&](auto& stage) {
+      stage.ProcessBlock(inputs, scratch, nChans, nFrames);
+
+      for (auto c = 0; c < nChans; c++)
+      {
+        for (auto s = 0; s < nFrames; s++)
+        {
+          outputs[c][s] += scratch[c][s];
+        }
+      }
+    };
+
+    (processStage(std::get<Is>(mStages)), ...);
+  }
+
+  std::tuple<Stages&...> mStages;
+  T mInput[NC][Base::kTileSize];
+  T mScratch[NC][Base::kTileSize];
+};
+
+/** Create a BlockStage, deducing the type of the callable */
+template <typename T, typename F>
+BlockStage<T, F> MakeBlockStage(F func) { return BlockStage<T, F>(std::move(func)); }
+
+/** Create a SampleStage, deducing the type of the callable */
+template <typename T, typename F>
+SampleStage<T, F> MakeSampleStage(F func) { return SampleStage<T, F>(std::move(func)); }
+
+/** Create a SerialChain, deducing the types of the stages */
+template <typename T, int NC, typename... Stages>
+SerialChain<T, NC, Stages...> MakeSerialChain(Stages&... stages) { return SerialChain<T, NC, Stages...>(stages...); }
+
+/** Create a ParallelChain, deducing the types of the stages */
+template <typename T, int NC, typename... Stages>
+ParallelChain<T, NC, Stages...> MakeParallelChain(Stages&... stages) { return ParallelChain<T, NC, Stages...>(stages...); }
+
+END_IPLUG_NAMESPACE
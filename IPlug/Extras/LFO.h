@@ -109,9 +109,12 @@ public:
     return DoProcess(IOscillator<T>::mPhase);
   }
 
-  /* Block process function */
+  /* Block process function. The phases for the whole block are computed first, and then the shape is applied in one loop per shape, so that both loops can be vectorized */
   void ProcessBlock(T* pOutput, int nFrames, double qnPos = 0., bool transportIsRunning = false, double tempo = 120.)
   {
+    if (nFrames <= 0)
+      return;
+    
     T oneOverQNScalar = 1./mQNScalar;
     T phase = IOscillator<T>::mPhase;
     
@@ -122,24 +125,34 @@ public:
     
     T phaseIncr = IOscillator<T>::mPhaseIncr;
 
-    for (int s=0; s<nFrames; s++)
+    if(mRateMode == ERateMode::kBPM && transportIsRunning)
     {
-      double sampleAccurateQnPos = qnPos + ((double) s / samplesPerBeat);
+      // Rather than taking fmod() of the sample accurate QN position every sample, find the phase at the start of the block and advance it by the division's cycles per sample
+      const double startPhase = std::fmod(qnPos, oneOverQNScalar) / oneOverQNScalar;
+      const double cyclesPerSample = 1. / (samplesPerBeat * oneOverQNScalar);
 
-      if(mRateMode == ERateMode::kBPM)
+      for (int s=0; s<nFrames; s++)
       {
-        if(transportIsRunning)
-          phase = std::fmod(sampleAccurateQnPos, oneOverQNScalar) / oneOverQNScalar;
-        else
-          phase = WrapPhase(phase + (phaseIncr * mQNScalar));
+        const double p = startPhase + s * cyclesPerSample;
+        pOutput[s] = static_cast<T>(p - std::floor(p));
       }
-      else
-        phase = WrapPhase(phase + phaseIncr);
+    }
+    else
+    {
+      if(mRateMode == ERateMode::kBPM)
+        phaseIncr *= mQNScalar;
       
-      pOutput[s] = DoProcess(phase);
+      for (int s=0; s<nFrames; s++)
+      {
+        phase += phaseIncr;
+        phase -= std::floor(phase); // equivalent to WrapPhase(), without the loops
+        pOutput[s] = phase;
+      }
     }
     
-    IOscillator<T>::mPhase = phase;
+    IOscillator<T>::mPhase = pOutput[nFrames-1];
+    
+    ApplyShape(pOutput, nFrames);
   }
   
   void SetShape(int lfoShape)
@@ -187,45 +200,57 @@ private:
     return x;
   };
   
+  static inline T Triangle(T x) { return (2. * (1. - std::abs((WrapPhase(x + 0.25) * 2.) -1.))) - 1.; }
+  static inline T TriangleUnipolar(T x) { return 1. - std::abs((x * 2.) - 1. ); }
+  static inline T Square(T x) { return std::copysign(1., x - 0.5); }
+  static inline T SquareUnipolar(T x) { return std::copysign(0.5, x - 0.5) + 0.5; }
+  static inline T RampUp(T x) { return (x * 2.) - 1.; }
+  static inline T RampUpUnipolar(T x) { return x; }
+  static inline T RampDown(T x) { return ((1. - x) * 2.) - 1.; }
+  static inline T RampDownUnipolar(T x) { return 1. - x; }
+  static inline T Sine(T x) { return std::sin(x * 6.283185307179586); }
+  static inline T SineUnipolar(T x) { return (std::sin(x * 6.283185307179586) * 0.5) + 0.5; }
+  
   inline T DoProcess(T phase)
   {
-    auto triangle         = [](T x){ return (2. * (1. - std::abs((WrapPhase(x + 0.25) * 2.) -1.))) - 1.; };
-    auto triangleUnipolar = [](T x){ return 1. - std::abs((x * 2.) - 1. ); };
-    auto square           = [](T x){ return std::copysign(1., x - 0.5); };
-    auto squareUnipolar   = [](T x){ return std::copysign(0.5, x - 0.5) + 0.5; };
-    auto rampup           = [](T x){ return (x * 2.) - 1.; };
-    auto rampupUnipolar   = [](T x){ return x; };
-    auto rampdown         = [](T x){ return ((1. - x) * 2.) - 1.; };
-    auto rampdownUnipolar = [](T x){ return 1. - x; };
+    T output = phase;
+    ApplyShape(&output, 1);
     
-    T output = 0.;
+    return output;
+  }
+  
+  /** Replace a buffer of phases with the scaled output of the current shape. The shape is chosen once, outside the loop */
+  void ApplyShape(T* pBuffer, int nFrames)
+  {
+    auto apply = [pBuffer, nFrames, levelScalar = mLevelScalar](auto shapeFunc) {
+      for (int s=0; s<nFrames; s++)
+        pBuffer[s] = shapeFunc(pBuffer[s]) * levelScalar;
+    };
     
     if(mPolarity == EPolarity::kUnipolar)
     {
       switch (mShape) {
-        case kTriangle: output = triangleUnipolar(phase); break;
-        case kSquare:   output = squareUnipolar(phase); break;
-        case kRampUp:   output = rampupUnipolar(phase); break;
-        case kRampDown: output = rampdownUnipolar(phase); break;
-        case kSine:     output = (std::sin(phase * 6.283185307179586) * 0.5) + 0.5; break;
-        default: break;
+        case kTriangle: apply(TriangleUnipolar); break;
+        case kSquare:   apply(SquareUnipolar); break;
+        case kRampUp:   apply(RampUpUnipolar); break;
+        case kRampDown: apply(RampDownUnipolar); break;
+        case kSine:     apply(SineUnipolar); break;
+        default: apply([](T) { return T(0.); }); break;
       }
     }
     else
     {
       switch (mShape) {
-        case kTriangle: output = triangle(phase); break;
-        case kSquare:   output = square(phase); break;
-        case kRampUp:   output = rampup(phase); break;
-        case kRampDown: output = rampdown(phase); break;
-        case kSine:     output = std::sin(phase * 6.283185307179586); break;
-        default: break;
+        case kTriangle: apply(Triangle); break;
+        case kSquare:   apply(Square); break;
+        case kRampUp:   apply(RampUp); break;
+        case kRampDown: apply(RampDown); break;
+        case kSine:     apply(Sine); break;
+        default: apply([](T) { return T(0.); }); break;
       }
     }
     
-    mLastOutput = output * mLevelScalar;
-    
-    return mLastOutput;
+    mLastOutput = pBuffer[nFrames-1];
   }
 
 private:
@@ -59,6 +59,9 @@
 #include <utility>
 #include <cmath>
 #include <cstring>
+#include <memory>
+#include <vector>
+#include <cassert>
 
 #if defined IPLUG_SIMDE
   #if defined(__arm64__)
@@ -70,9 +73,72 @@
 #endif
 
 #include "IPlugConstants.h"
+#include "SharedAssets.h"
 
 namespace iplug
 {
+/* LanczosTables
+ *
+ * The windowed sinc table and its deltas used by LanczosResampler. The tables only depend on the
+ * sample type and the filter size, so one instance is shared through SharedAssets by every resampler
+ * with those parameters, whatever its channel count or buffer size. The tables are built on first use,
+ * and freed when the last resampler using them is destroyed.
+ */
+template<typename T, size_t A>
+struct LanczosTables
+{
+  // The filter width. 2x because the filter goes from -A to A
+  static constexpr size_t kFilterWidth = A * 2;
+  // The discretization resolution for the filter table.
+  static constexpr size_t kTablePoints = 8192;
+  static constexpr double kDeltaX = 1.0 / (kTablePoints);
+
+  static std::shared_ptr<const LanczosTables> Get()
+  {
+    return SharedAssets::Get<LanczosTables>(0, 0., []() { return std::unique_ptr<LanczosTables>(new LanczosTables); });
+  }
+
+  alignas(32) T mTable[kTablePoints + 1][kFilterWidth];
+  alignas(32) T mDeltaTable[kTablePoints + 1][kFilterWidth];
+
+private:
+  LanczosTables()
+  {
+    auto kernel = [](double x) {
+      if (std::fabs(x) < 1e-7)
+        return T(1.0);
+      
+      const auto pi = iplug::PI;
+      return T(A * std::sin(pi * x) * std::sin(pi * x / A) / (pi * pi * x * x));
+    };
+    
+    for (auto t=0; t<kTablePoints+1; ++t)
+    {
+      const double x0 = kDeltaX * t;
+      
+      for (auto i=0; i<kFilterWidth; ++i)
+      {
+        const double x = x0 + i - A;
+        mTable[t][i] = kernel(x);
+      }
+    }
+    
+    for (auto t=0; t<kTablePoints; ++t)
+    {
+      for (auto i=0; i<kFilterWidth; ++i)
+      {
+        mDeltaTable[t][i] = mTable[t + 1][i] - mTable[t][i];
+      }
+    }
+    
+    for (auto i=0; i<kFilterWidth; ++i)
+    {
+      // Wrap at the end - delta is the same
+      mDeltaTable[kTablePoints][i] = mDeltaTable[0][i];
+    }
+  }
+};
+
 /* LanczosResampler
  *
  * A class that implements Lanczos resampling, optionally using SIMD instructions.
@@ -80,10 +146,14 @@ namespace iplug
  * include the SIMDE library in your search paths in order to translate intel
  * intrinsics to e.g. arm64
  *
+ * The input history is stored channel-interleaved, and the portable path accumulates all channels
+ * for each filter tap in its inner loop, so that the compiler can vectorize across channels with
+ * whatever instruction set is targeted (e.g. AVX2 or NEON), without relaxing floating point ordering.
+ *
  * See https://en.wikipedia.org/wiki/Lanczos_resampling
  *
  * @tparam T the sampletype
- * @tparam NCHANS the number of channels
+ * @tparam NCHANS the default number of channels, which can be overridden at construction
  * @tparam A The Lanczos filter size. A higher value makes the filter closer to an 
    ideal stop-band that rejects high-frequency content (anti-aliasing), 
    but at the expense of higher latency
@@ -96,63 +166,39 @@ private:
   static_assert(std::is_same<T, float>::value, "LanczosResampler requires T to be float when using SIMD instructions");
 #endif
 
-  // The buffer size. This needs to be at least as large as the largest block of samples
-  // that the input side will see.
-  static constexpr size_t kBufferSize = 4096;
-  // The filter width. 2x because the filter goes from -A to A
-  static constexpr size_t kFilterWidth = A * 2;
-  // The discretization resolution for the filter table.
-  static constexpr size_t kTablePoints = 8192;
-  static constexpr double kDeltaX = 1.0 / (kTablePoints);
+  using Tables = LanczosTables<T, A>;
+  static constexpr size_t kFilterWidth = Tables::kFilterWidth;
+  static constexpr size_t kTablePoints = Tables::kTablePoints;
 
 public:
+  // The default buffer size. This needs to be at least as large as the largest block of samples
+  // that the input side will see.
+  static constexpr size_t kDefaultBufferSize = 4096;
+
   /** Constructor
     * @param inputRate The input sample rate
     * @param outputRate The output sample rate
+    * @param nChans The number of channels
+    * @param bufferSize The size of the input history in samples per channel, rounded up to a power of two.
+    * This must exceed the largest block pushed plus the filter width
     */
-  LanczosResampler(float inputRate, float outputRate)
+  LanczosResampler(float inputRate, float outputRate, int nChans = NCHANS, size_t bufferSize = kDefaultBufferSize)
   : mInputSampleRate(inputRate)
   , mOutputSamplerate(outputRate)
   , mPhaseOutIncr(mInputSampleRate / mOutputSamplerate)
+  , mNChans(nChans)
+  , mTables(Tables::Get())
   {
-    ClearBuffer();
+    assert(nChans > 0);
+
+    mBufferSize = 1;
     
-    auto kernel = [](double x) {
-      if (std::fabs(x) < 1e-7)
-        return T(1.0);
-      
-      const auto pi = iplug::PI;
-      return T(A * std::sin(pi * x) * std::sin(pi * x / A) / (pi * pi * x * x));
-    };
+    while (mBufferSize < std::max(bufferSize, kFilterWidth * 2))
+      mBufferSize <<= 1;
     
-    if (!sTablesInitialized)
-    {
-      for (auto t=0; t<kTablePoints+1; ++t)
-      {
-        const double x0 = kDeltaX * t;
-        
-        for (auto i=0; i<kFilterWidth; ++i)
-        {
-          const double x = x0 + i - A;
-          sTable[t][i] = kernel(x);
-        }
-      }
-      
-      for (auto t=0; t<kTablePoints; ++t)
-      {
-        for (auto i=0; i<kFilterWidth; ++i)
-        {
-          sDeltaTable[t][i] = sTable[t + 1][i] - sTable[t][i];
-        }
-      }
-      
-      for (auto i=0; i<kFilterWidth; ++i)
-      {
-        // Wrap at the end - delta is the same
-        sDeltaTable[kTablePoints][i] = sDeltaTable[0][i];
-      }
-      sTablesInitialized = true;
-    }
+    mInputBuffer.resize(mBufferSize * 2 * mNChans);
+    mSum.resize(mNChans);
+    ClearBuffer();
   }
   
   inline size_t GetNumSamplesRequiredFor(size_t nOutputSamples) const
@@ -170,21 +216,29 @@ public:
   
   inline void PushBlock(T** inputs, size_t nFrames, int nChans)
   {
+    assert(nChans <= mNChans);
+    
+    const size_t mirrorOffset = mBufferSize * mNChans;
+    
     for (auto s=0; s<nFrames; s++)
     {
+      T* pFrame = mInputBuffer.data() + mWritePos * mNChans;
+      
       for (auto c=0; c<nChans; c++)
       {
-        mInputBuffer[c][mWritePos] = inputs[c][s];
-        mInputBuffer[c][mWritePos + kBufferSize] = inputs[c][s]; // this way we can always wrap
+        pFrame[c] = inputs[c][s];
+        pFrame[c + mirrorOffset] = inputs[c][s]; // this way we can always wrap
       }
       
-      mWritePos = (mWritePos + 1) & (kBufferSize - 1);
+      mWritePos = (mWritePos + 1) & (mBufferSize - 1);
       mPhaseIn += mPhaseInIncr;
     }
   }
   
   size_t PopBlock(T** outputs, size_t max, int nChans)
   {
+    assert(nChans <= mNChans);
+    
     int populated = 0;
     while (populated < max && (mPhaseIn - mPhaseOut) > A + 1)
     {
@@ -208,116 +262,120 @@ public:
   
   void ClearBuffer()
   {
-    memset(mInputBuffer, 0, NCHANS * kBufferSize * 2 * sizeof(T));
+    std::fill(mInputBuffer.begin(), mInputBuffer.end(), T(0));
   }
   
+  /** @return The number of channels the resampler was constructed for */
+  int NChans() const { return mNChans; }
+  
+  /** @return The size of the input history in samples per channel */
+  size_t GetBufferSize() const { return mBufferSize; }
+  
 private:
-#ifdef IPLUG_SIMDE
-  inline void ReadSamples(double xBack, T** outputs, int s, int nChans) const
+  /** Find where to read for an output sample
+   * @return The buffer index of the centre tap, with the table row and fractional position in tableIndex and tableFracPosition */
+  template <typename P>
+  inline int GetReadPosition(double xBack, int& tableIndex, P& tableFracPosition) const
   {
-    float bufferReadPosition = static_cast<float>(mWritePos - xBack);
+    P bufferReadPosition = static_cast<P>(mWritePos - xBack);
     int bufferReadIndex = static_cast<int>(std::floor(bufferReadPosition));
-    float bufferFracPosition = 1.0f - (bufferReadPosition - static_cast<float>(bufferReadIndex));
+    P bufferFracPosition = P(1) - (bufferReadPosition - static_cast<P>(bufferReadIndex));
     
-    bufferReadIndex = (bufferReadIndex + kBufferSize) & (kBufferSize - 1);
-    bufferReadIndex += (bufferReadIndex <= static_cast<int>(A)) * kBufferSize;
+    bufferReadIndex = (bufferReadIndex + static_cast<int>(mBufferSize)) & static_cast<int>(mBufferSize - 1);
+    bufferReadIndex += (bufferReadIndex <= static_cast<int>(A)) * static_cast<int>(mBufferSize);
     
-    float tablePosition = bufferFracPosition * kTablePoints;
-    int tableIndex = static_cast<int>(tablePosition);
-    float tableFracPosition = (tablePosition - tableIndex);
+    P tablePosition = bufferFracPosition * kTablePoints;
+    tableIndex = static_cast<int>(tablePosition);
+    tableFracPosition = (tablePosition - tableIndex);
     
-    __m128 sum[NCHANS];
-    for (auto & v : sum) {
-      v = _mm_setzero_ps(); // Initialize sum vectors to zero
-    }
+    return bufferReadIndex;
+  }
+
+#ifdef IPLUG_SIMDE
+  inline void ReadSamples(double xBack, T** outputs, int s, int nChans) const
+  {
+    int tableIndex;
+    float tableFracPosition;
+    const int bufferReadIndex = GetReadPosition(xBack, tableIndex, tableFracPosition);
+    const T* pBuffer = mInputBuffer.data();
+    const int stride = mNChans;
     
-    for (int i=0; i<A; i+=4) // Process four samples at a time
+    for (int c=0; c<nChans; c++)
     {
-      // Load filter coefficients and input samples into SSE registers
-      __m128 f0 = _mm_load_ps(&sTable[tableIndex][i]);
-      __m128 df0 = _mm_load_ps(&sDeltaTable[tableIndex][i]);
-      __m128 f1 = _mm_load_ps(&sTable[tableIndex][A + i]);
-      __m128 df1 = _mm_load_ps(&sDeltaTable[tableIndex][A + i]);
-      
-      // Interpolate filter coefficients
-      __m128 tfp = _mm_set1_ps(tableFracPosition);
-      f0 = _mm_add_ps(f0, _mm_mul_ps(df0, tfp));
-      f1 = _mm_add_ps(f1, _mm_mul_ps(df1, tfp));
+      __m128 sum = _mm_setzero_ps();
       
-      for (int c=0; c<nChans; c++)
+      for (int i=0; i<A; i+=4) // Process four samples at a time
       {
+        // Load filter coefficients and input samples into SSE registers
+        __m128 f0 = _mm_load_ps(&mTables->mTable[tableIndex][i]);
+        __m128 df0 = _mm_load_ps(&mTables->mDeltaTable[tableIndex][i]);
+        __m128 f1 = _mm_load_ps(&mTables->mTable[tableIndex][A + i]);
+        __m128 df1 = _mm_load_ps(&mTables->mDeltaTable[tableIndex][A + i]);
+        
+        // Interpolate filter coefficients
+        __m128 tfp = _mm_set1_ps(tableFracPosition);
+        f0 = _mm_add_ps(f0, _mm_mul_ps(df0, tfp));
+        f1 = _mm_add_ps(f1, _mm_mul_ps(df1, tfp));
+        
         // Load input data
-        __m128 d0 = _mm_set_ps(mInputBuffer[c][bufferReadIndex - A + i + 3],
-                               mInputBuffer[c][bufferReadIndex - A + i + 2],
-                               mInputBuffer[c][bufferReadIndex - A + i + 1],
-                               mInputBuffer[c][bufferReadIndex - A + i]);
-        __m128 d1 = _mm_set_ps(mInputBuffer[c][bufferReadIndex + i + 3],
-                               mInputBuffer[c][bufferReadIndex + i + 2],
-                               mInputBuffer[c][bufferReadIndex + i + 1],
-                               mInputBuffer[c][bufferReadIndex + i]);
+        const T* p0 = pBuffer + (bufferReadIndex - A + i) * stride + c;
+        const T* p1 = pBuffer + (bufferReadIndex + i) * stride + c;
+        __m128 d0 = _mm_set_ps(p0[3 * stride], p0[2 * stride], p0[stride], p0[0]);
+        __m128 d1 = _mm_set_ps(p1[3 * stride], p1[2 * stride], p1[stride], p1[0]);
         
         // Perform multiplication and accumulate
         __m128 result0 = _mm_mul_ps(f0, d0);
         __m128 result1 = _mm_mul_ps(f1, d1);
-        sum[c] = _mm_add_ps(sum[c], _mm_add_ps(result0, result1));
+        sum = _mm_add_ps(sum, _mm_add_ps(result0, result1));
       }
-    }
-    
-    // Extract the final sums and store them in the output
-    for (int c=0; c<nChans; c++)
-    {
+      
+      // Extract the final sum and store it in the output
       float sumArray[4];
-      _mm_store_ps(sumArray, sum[c]);
+      _mm_storeu_ps(sumArray, sum);
       outputs[c][s] = sumArray[0] + sumArray[1] + sumArray[2] + sumArray[3];
     }
   }
-#else // scalar
+#else // portable, vectorized across channels
   inline void ReadSamples(double xBack, T** outputs, int s, int nChans) const
   {
-    double bufferReadPosition = mWritePos - xBack;
-    int bufferReadIndex = std::floor(bufferReadPosition);
-    double bufferFracPosition = 1.0 - (bufferReadPosition - bufferReadIndex);
+    int tableIndex;
+    double tableFracPosition;
+    const int bufferReadIndex = GetReadPosition(xBack, tableIndex, tableFracPosition);
 
-    bufferReadIndex = (bufferReadIndex + kBufferSize) & (kBufferSize - 1);
-    bufferReadIndex += (bufferReadIndex <= static_cast<int>(A)) * kBufferSize;
+    // Interpolate the filter coefficients once for all channels
+    alignas(32) T coeffs[kFilterWidth];
+    const T* pTable = mTables->mTable[tableIndex];
+    const T* pDelta = mTables->mDeltaTable[tableIndex];
+    const T frac = static_cast<T>(tableFracPosition);
+    
+    for (auto i=0; i<kFilterWidth; i++)
+      coeffs[i] = pTable[i] + pDelta[i] * frac;
 
-    double tablePosition = bufferFracPosition * kTablePoints;
-    int tableIndex = static_cast<int>(tablePosition);
-    double tableFracPosition = (tablePosition - tableIndex);
+    T* pSum = mSum.data();
+    std::fill(pSum, pSum + nChans, T(0));
 
-    T sum[NCHANS] = {0.0};
+    const int stride = mNChans;
+    const T* pFrames = mInputBuffer.data() + (bufferReadIndex - static_cast<int>(A)) * stride;
 
-    for (auto i=0; i<A; i++)
+    for (auto i=0; i<kFilterWidth; i++)
     {
-      auto f0 = sTable[tableIndex][i];
-      const auto df0 = sDeltaTable[tableIndex][i];
-      f0 += df0 * tableFracPosition;
-
-      auto f1 = sTable[tableIndex][A+i];
-      const auto df1 = sDeltaTable[tableIndex][A+i];
-      f1 += df1 * tableFracPosition;
-
-      for (auto c=0; c<nChans;c++)
-      {
-        const auto d0 = mInputBuffer[c][bufferReadIndex - A + i];
-        const auto d1 = mInputBuffer[c][bufferReadIndex + i];
-        const auto rv = (f0 * d0) + (f1 * d1);
-        sum[c] += rv;
-      }
+      const T coeff = coeffs[i];
+      const T* pFrame = pFrames + i * stride;
+      
+      for (auto c=0; c<nChans; c++)
+        pSum[c] += coeff * pFrame[c];
     }
 
-    for (auto c=0; c<nChans;c++)
+    for (auto c=0; c<nChans; c++)
     {
-      outputs[c][s] = sum[c];
+      outputs[c][s] = pSum[c];
     }
   }
 #endif
   
-  static T sTable alignas(16)[kTablePoints + 1][kFilterWidth];
-  static T sDeltaTable alignas(16)[kTablePoints + 1][kFilterWidth];
-  static bool sTablesInitialized;
-  
-  T mInputBuffer[NCHANS][kBufferSize * 2];
+  std::vector<T> mInputBuffer; // channel-interleaved, mirrored so that reads never need to wrap
+  mutable std::vector<T> mSum;
+  size_t mBufferSize = kDefaultBufferSize;
   int mWritePos = 0;
   const float mInputSampleRate;
   const float mOutputSamplerate;
@@ -325,16 +383,8 @@ private:
   double mPhaseOut = 0.0;
   double mPhaseInIncr = 1.0;
   double mPhaseOutIncr = 0.0;
+  const int mNChans;
+  std::shared_ptr<const Tables> mTables;
 } WDL_FIXALIGN;
 
-template<typename T, int NCHANS, size_t A>
-T LanczosResampler<T, NCHANS, A>::sTable alignas(16) [LanczosResampler<T, NCHANS, A>::kTablePoints + 1][LanczosResampler::kFilterWidth];
-
-template<typename T, int NCHANS, size_t A>
-T LanczosResampler<T, NCHANS, A>::sDeltaTable alignas(16) [LanczosResampler<T, NCHANS, A>::kTablePoints + 1][LanczosResampler::kFilterWidth];
-
-template<typename T, int NCHANS, size_t A>
-bool LanczosResampler<T, NCHANS, A>::sTablesInitialized{false};
-
 } // namespace iplug
-
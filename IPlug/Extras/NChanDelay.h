@@ -1,19 +1,26 @@
 /*
  ==============================================================================
- 
- This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers. 
- 
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
  See LICENSE.txt for  more info.
- 
+
  ==============================================================================
 */
 
 #pragma once
+
+#include <algorithm>
+#include <cstring>
+
 #include "IPlugPlatform.h"
+#include "IPlugUtilities.h"
 
 BEGIN_IPLUG_NAMESPACE
 
-// A static delayline used to delay bypassed signals to match mLatency in AAX/VST3/AU
+/** A multichannel delay line, used to delay bypassed signals to match mLatency in AAX/VST3/AU, and usable for delay and chorus effects.
+ * Each channel has its own contiguous, power of two sized ring buffer, so blocks are written and read as whole spans (at most two memcpys per channel),
+ * rather than sample by sample. Modulated delays are read with linear interpolation */
 template<typename T>
 class NChanDelayLine
 {
@@ -21,48 +28,130 @@ public:
   NChanDelayLine(int nInputChans = 2, int nOutputChans = 2)
   : mNInChans(nInputChans)
   , mNOutChans(nOutputChans)
-  {}
+  {
+    SetMaxDelayTime(0);
+  }
 
+  /** Set a fixed delay, used by ProcessBlock(T**, T**, int). This allocates memory, and clears the buffer
+   * @param delayTimeSamples The delay in samples */
   void SetDelayTime(int delayTimeSamples)
   {
-    mDTSamples = delayTimeSamples;
-    mBuffer.Resize(mNInChans * delayTimeSamples);
+    SetMaxDelayTime(delayTimeSamples);
+    mDTSamples = std::max(delayTimeSamples, 0);
+  }
+
+  /** Allocate enough memory for a maximum delay, e.g. for modulated delays. This clears the buffer
+   * @param maxDelayTimeSamples The longest delay that will be used, in samples */
+  void SetMaxDelayTime(int maxDelayTimeSamples)
+  {
+    mMaxDTSamples = std::max(maxDelayTimeSamples, 0);
+    mDTSamples = std::min(mDTSamples, mMaxDTSamples);
+
+    // Leave room for at least kMinSpanSize new samples, so that a span can be written before the delayed span is read, even when processing in place
+    mBufferSize = 1;
+    while (mBufferSize < mMaxDTSamples + kMinSpanSize + 1)
+      mBufferSize <<= 1;
+
+    mSpanSize = mBufferSize - mMaxDTSamples - 1;
+    mBuffer.Resize(mNInChans * mBufferSize);
     mWriteAddress = 0;
     ClearBuffer();
   }
 
   void ClearBuffer()
   {
-    memset(mBuffer.Get(), 0, mNInChans * mDTSamples * sizeof(T));
+    memset(mBuffer.Get(), 0, mBuffer.GetSize() * sizeof(T));
   }
 
+  /** @return The fixed delay in samples */
+  int GetDelayTime() const { return mDTSamples; }
+
+  /** @return The longest delay that can be used, in samples */
+  int GetMaxDelayTime() const { return mMaxDTSamples; }
+
+  /** Delay every channel by the fixed delay. Inputs and outputs may be the same buffers */
   void ProcessBlock(T** inputs, T** outputs, int nFrames)
   {
-    T* buffer = mBuffer.Get();
+    const int nChans = std::min(mNInChans, mNOutChans);
+    const int mask = mBufferSize - 1;
+
+    for (auto start = 0; start < nFrames; start += mSpanSize)
+    {
+      const int n = std::min(mSpanSize, nFrames - start);
+
+      for (auto c = 0; c < nChans; c++)
+      {
+        T* pChanBuffer = mBuffer.Get() + c * mBufferSize;
+        WriteSpan(pChanBuffer, mWriteAddress, inputs[c] + start, n);
+        ReadSpan(pChanBuffer, (mWriteAddress - mDTSamples) & mask, outputs[c] + start, n);
+      }
+
+      mWriteAddress = (mWriteAddress + n) & mask;
+    }
+  }
+
+  /** Delay every channel by a modulated, fractional delay, reading with linear interpolation. Inputs and outputs may be the same buffers
+   * @param delaySamples nFrames delay times in samples, shared by all channels, which are clipped to the range 0 to GetMaxDelayTime() */
+  void ProcessBlock(T** inputs, T** outputs, const T* delaySamples, int nFrames)
+  {
+    const int nChans = std::min(mNInChans, mNOutChans);
+    const int mask = mBufferSize - 1;
+    const double maxDelay = static_cast<double>(mMaxDTSamples);
 
-    for (auto s = 0 ; s < nFrames; ++s)
+    for (auto start = 0; start < nFrames; start += mSpanSize)
     {
-      for (auto c = 0; c < mNInChans; c++)
+      const int n = std::min(mSpanSize, nFrames - start);
+
+      for (auto c = 0; c < nChans; c++)
       {
-        if (c < mNOutChans)
+        T* pChanBuffer = mBuffer.Get() + c * mBufferSize;
+        T* pOutput = outputs[c] + start;
+        const T* pDelay = delaySamples + start;
+
+        WriteSpan(pChanBuffer, mWriteAddress, inputs[c] + start, n);
+
+        // The whole span is written first, so a delay of 0 reads the sample just written. Adding mBufferSize keeps the read position positive, so truncation is floor.
+        // The position is in double precision, so that the fraction stays accurate in long buffers
+        for (auto s = 0; s < n; s++)
         {
-          T input = inputs[c][s];
-          const int offset = c * mDTSamples;
-          outputs[c][s] = buffer[offset + mWriteAddress];
-          buffer[offset + mWriteAddress] = input;
+          const double readPos = static_cast<double>(mWriteAddress + s + mBufferSize) - Clip(static_cast<double>(pDelay[s]), 0., maxDelay);
+          const int idx = static_cast<int>(readPos);
+          const T frac = static_cast<T>(readPos - idx);
+          const T a = pChanBuffer[idx & mask];
+          const T b = pChanBuffer[(idx + 1) & mask];
+          pOutput[s] = a + frac * (b - a);
         }
       }
 
-      mWriteAddress++;
-      mWriteAddress %= mDTSamples;
+      mWriteAddress = (mWriteAddress + n) & mask;
     }
   }
 
 private:
+  /** The smallest number of samples processed at once, if the block is larger than this it is processed in several spans */
+  static constexpr int kMinSpanSize = 512;
+
+  inline void WriteSpan(T* pChanBuffer, int pos, const T* pSrc, int n) const
+  {
+    const int first = std::min(n, mBufferSize - pos);
+    memcpy(pChanBuffer + pos, pSrc, first * sizeof(T));
+    memcpy(pChanBuffer, pSrc + first, (n - first) * sizeof(T));
+  }
+
+  inline void ReadSpan(const T* pChanBuffer, int pos, T* pDest, int n) const
+  {
+    const int first = std::min(n, mBufferSize - pos);
+    memcpy(pDest, pChanBuffer + pos, first * sizeof(T));
+    memcpy(pDest + first, pChanBuffer, (n - first) * sizeof(T));
+  }
+
   WDL_TypedBuf<T> mBuffer;
-  uint32_t mNInChans, mNOutChans;
-  uint32_t mWriteAddress = 0;
-  uint32_t mDTSamples = 0;
+  int mNInChans, mNOutChans;
+  int mWriteAddress = 0;
+  int mDTSamples = 0;
+  int mMaxDTSamples = 0;
+  int mBufferSize = 0;
+  int mSpanSize = 0;
 } WDL_FIXALIGN;
 
 END_IPLUG_NAMESPACE
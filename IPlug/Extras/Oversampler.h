@@ -173,8 +173,10 @@ public:
    * @param nFrames The block size for this block: number of samples per channel.
    * @param nInChans The number of input channels to process. Must be less or equal to the number of channels passed to the constructor
    * @param nOutChans The number of output channels to process. Must be less or equal to the number of channels passed to the constructor
-   * @param func The function that processes the audio sample at the higher sampling rate. NOTE: std::function can call malloc if you pass in captures */
-  void ProcessBlock(T** inputs, T** outputs, int nFrames, int nInChans, int nOutChans, BlockProcessFunc func)
+   * @param func The function that processes the audio sample at the higher sampling rate, any callable with the signature void(T**, T**, int), e.g. a lambda or a SerialChain.
+   * It is called directly, so it can be inlined and captures never allocate, unlike when passing a BlockProcessFunc (std::function) */
+  template <typename F>
+  void ProcessBlock(T** inputs, T** outputs, int nFrames, int nInChans, int nOutChans, F&& func)
   {
     assert(nInChans <= mNInChannels);
     assert(nOutChans <= mNOutChannels);
@@ -250,9 +252,10 @@ public:
   
   /** Over sample an input sample with a per-sample function (up-sample input -> process with function -> down-sample)
    * @param input The audio sample to input
-   * @param std::function<double(double)> The function that processes the audio sample at the higher sampling rate. NOTE: std::function can call malloc if you pass in captures
+   * @param func The function that processes the audio sample at the higher sampling rate, any callable with the signature T(T)
    * @return The audio sample output */
-  T Process(T input, std::function<T(T)> func)
+  template <typename F>
+  T Process(T input, F&& func)
   {
     T output;
 
@@ -318,9 +321,10 @@ public:
   }
 
   /** Over-sample an per-sample synthesis function
-   * @param genFunc The function that generates the audio sample
+   * @param genFunc The function that generates the audio sample, any callable with the signature T()
    * @return The audio sample output */
-  T ProcessGen(std::function<T()> genFunc)
+  template <typename F>
+  T ProcessGen(F&& genFunc)
   {
     auto ProcessDown16x = [&](T input)
     {
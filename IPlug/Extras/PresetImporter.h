@@ -0,0 +1,570 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @brief Asynchronous import of VST2 format presets and banks (FXP/FXB), and of banks written by IPluginBase::SerializePresets()
+ *
+ * IPluginBase::LoadPresetFromFXP() and IPluginBase::LoadBankFromFXB() read the whole file, then byte swap and set each parameter on the calling thread.
+ * PresetImporter instead streams the file on a worker thread, converting the big endian values a block at a time, and builds the finished preset states there.
+ * The result is published with a single atomic pointer exchange, and the main thread applies it in one step, with ApplyParamValues() for a preset, or by swapping the
+ * prepared states into the plug-in's presets for a bank:
+ *
+ * // main thread, e.g. from a file dialog
+ * mImporter.StartFXB(*this, path.Get());
+ * // main thread, e.g. OnIdle()
+ * mImporter.Apply(*this);
+ *
+ * The plug-in's parameters and presets must not be added or removed while an import is running. By default a bank's preset states are made on the main thread in Apply(),
+ * with UnserializePresets() for a native bank, and by setting the values of each 'FxCk' preset and calling SerializeState() for an 'FxBk' bank, so custom state is kept.
+ * Plug-ins whose state contains only parameters, as written by the default SerializeState(), can call SetStatesContainOnlyParams(true), so that the worker builds the preset states too
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "IPlugPlatform.h"
+#include "IPlugPluginBase.h"
+#include "fileread.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+class PresetImporter
+{
+public:
+  enum EFormat
+  {
+    /** A VST2 preset, which is either a state chunk ('FPCh') or normalized parameter values ('FxCk') */
+    kFormatFXP = 0,
+    /** A VST2 bank, which is either a SerializePresets() bank ('FBCh') or a list of 'FxCk' presets ('FxBk') */
+    kFormatFXB,
+    /** The data written by SerializePresets(), optionally preceded by the iPlug version */
+    kFormatNativeBank
+  };
+
+  enum EStatus
+  {
+    kStatusIdle = 0,
+    kStatusParsing,
+    kStatusReady,
+    kStatusFailed
+  };
+
+  PresetImporter() {}
+
+  ~PresetImporter()
+  {
+    Cancel();
+  }
+
+  PresetImporter(const PresetImporter&) = delete;
+  PresetImporter& operator=(const PresetImporter&) = delete;
+
+  /** Start parsing a file on a worker thread, cancelling any import that is in progress. Call this on the main thread
+   * @param plug The plug-in, which must outlive the import or Cancel() must be called first
+   * @param path The full path to the file
+   * @param format The format of the file
+   * @return \c true if the worker was started */
+  bool Start(const IPluginBase& plug, const char* path, EFormat format)
+  {
+    Cancel();
+
+    if (!CStringHasContents(path))
+      return false;
+
+    mPlug = &plug;
+    mPath.Set(path);
+    mFormat = format;
+    mCancel = false;
+    mStatus = kStatusParsing;
+    mWorker = std::thread([this]() {
+      Result* pResult = Parse();
+
+      if (pResult)
+      {
+        mStatus = kStatusReady;
+        delete mReady.exchange(pResult);
+      }
+      else
+        mStatus = kStatusFailed;
+    });
+
+    return true;
+  }
+
+  /** Start importing a VST2 format preset, see Start() */
+  bool StartFXP(const IPluginBase& plug, const char* path) { return Start(plug, path, kFormatFXP); }
+
+  /** Start importing a VST2 format bank, see Start() */
+  bool StartFXB(const IPluginBase& plug, const char* path) { return Start(plug, path, kFormatFXB); }
+
+  /** Start importing a bank written by SerializePresets(), see Start() */
+  bool StartNativeBank(const IPluginBase& plug, const char* path) { return Start(plug, path, kFormatNativeBank); }
+
+  /** Stop the worker, and discard any result that has not been applied. Call this on the main thread */
+  void Cancel()
+  {
+    mCancel = true;
+
+    if (mWorker.joinable())
+      mWorker.join();
+
+    delete mReady.exchange(nullptr);
+    mStatus = kStatusIdle;
+  }
+
+  /** @return The state of the current import. kStatusReady means a result is waiting for Apply() */
+  EStatus GetStatus() const { return mStatus; }
+
+  /** Choose whether the plug-in's state contains only parameters, so that the worker can build the preset states of a bank. Call this before starting an import
+   * @param paramsOnly \c true if the plug-in uses the default SerializeState() and UnserializeState(). The default is \c false */
+  void SetStatesContainOnlyParams(bool paramsOnly) { mParamsOnly = paramsOnly; }
+
+  /** Apply the result of a finished import, if there is one. Call this on the main thread, e.g. from OnIdle()
+   * Like LoadBankFromFXB() and UnserializePresets(), applying a bank replaces the plug-in's state with the bank's current preset, or with the plug-in's current preset from the bank if the file does not say
+   * @param plug The plug-in that was passed to Start()
+   * @return \c true if a preset or bank was applied */
+  bool Apply(IPluginBase& plug)
+  {
+    Result* pResult = mReady.exchange(nullptr);
+
+    if (!pResult)
+      return false;
+
+    if (mWorker.joinable())
+      mWorker.join();
+
+    mStatus = kStatusIdle;
+
+    bool appliedOK = true;
+
+    switch (pResult->type)
+    {
+      case kResultParams:
+      {
+        plug.ApplyParamValues(pResult->values.data(), kPresetRecall);
+        plug.ModifyCurrentPreset(pResult->presets[0].name);
+        plug.OnPresetsModified();
+        plug.OnRestoreState();
+        break;
+      }
+      case kResultState:
+      {
+        appliedOK = plug.UnserializeState(pResult->presets[0].state, pResult->presets[0].startPos) >= 0;
+
+        if (appliedOK)
+        {
+          plug.ModifyCurrentPreset(pResult->presets[0].name);
+          plug.OnPresetsModified();
+          plug.OnRestoreState();
+        }
+        break;
+      }
+      case kResultBank:
+      {
+        const int n = std::min(plug.NPresets(), static_cast<int>(pResult->presets.size()));
+
+        for (auto i = 0; i < n; i++)
+        {
+          Preset& src = pResult->presets[i];
+          IPreset* pPreset = plug.GetPreset(i);
+          strncpy(pPreset->mName, src.name, MAX_PRESET_NAME_LEN - 1);
+          pPreset->mName[MAX_PRESET_NAME_LEN - 1] = 0;
+          pPreset->mInitialized = src.initialized;
+
+          if (src.initialized)
+            pPreset->mChunk.Swap(src.state);
+        }
+
+        appliedOK = plug.RestorePreset(pResult->currentPreset >= 0 && pResult->currentPreset < plug.NPresets() ? pResult->currentPreset : plug.GetCurrentPresetIdx());
+        break;
+      }
+      case kResultBankValues:
+      {
+        const int n = std::min(plug.NPresets(), static_cast<int>(pResult->presets.size()));
+
+        // As LoadBankFromFXB() does, each preset's custom state is kept, and its parameters are replaced before it is serialized again
+        for (auto i = 0; i < n; i++)
+        {
+          Preset& src = pResult->presets[i];
+          plug.RestorePreset(i);
+          plug.ApplyParamValues(src.values.data(), kPresetRecall, false);
+          plug.ModifyCurrentPreset(src.name);
+        }
+
+        appliedOK = n > 0 && plug.RestorePreset(pResult->currentPreset >= 0 && pResult->currentPreset < plug.NPresets() ? pResult->currentPreset : plug.GetCurrentPresetIdx());
+        break;
+      }
+      case kResultRawBank:
+      {
+        appliedOK = plug.UnserializePresets(pResult->presets[0].state, pResult->presets[0].startPos) >= 0;
+        break;
+      }
+    }
+
+    if (appliedOK)
+      plug.InformHostOfPresetChange();
+
+    delete pResult;
+    return appliedOK;
+  }
+
+private:
+  /** The number of values converted at a time, so that a bank of any size is streamed through a small buffer */
+  static constexpr int kBlockSize = 1024;
+
+  enum EResultType
+  {
+    /** One preset, as non-normalized parameter values */
+    kResultParams,
+    /** One preset, as a state chunk for UnserializeState() */
+    kResultState,
+    /** A bank, as one state chunk per preset, in the format of IPreset::mChunk */
+    kResultBank,
+    /** A bank, as non-normalized parameter values per preset, which Apply() serializes with SerializeState() */
+    kResultBankValues,
+    /** A bank, as a chunk for UnserializePresets() */
+    kResultRawBank
+  };
+
+  struct Preset
+  {
+    char name[MAX_PRESET_NAME_LEN] = {};
+    bool initialized = false;
+    IByteChunk state;
+    int startPos = 0;
+    std::vector<double> values;
+  };
+
+  /** Everything that Apply() needs, built on the worker and not modified once published */
+  struct Result
+  {
+    EResultType type = kResultParams;
+    std::vector<Preset> presets;
+    std::vector<double> values;
+    int currentPreset = -1;
+  };
+
+  /** Reads a file sequentially through WDL_FileRead's buffer, so it is never loaded into memory whole */
+  class Reader
+  {
+  public:
+    explicit Reader(const char* path)
+    : mFile(path, 0, 65536, 1)
+    {
+    }
+
+    bool IsOpen() { return mFile.IsOpen(); }
+
+    bool ReadBytes(void* pDst, int nBytes)
+    {
+      return nBytes >= 0 && mFile.Read(pDst, nBytes) == nBytes;
+    }
+
+    /** Read a big endian 32-bit value */
+    bool ReadBE32(int32_t& value)
+    {
+      uint32_t v;
+
+      if (!ReadBytes(&v, sizeof(v)))
+        return false;
+
+      SwapBlock(&v, 1);
+      value = static_cast<int32_t>(v);
+      return true;
+    }
+
+    /** Read big endian floats into native doubles, a block at a time */
+    bool ReadBEFloats(double* pDst, int n)
+    {
+      uint32_t block[kBlockSize];
+
+      for (auto start = 0; start < n; start += kBlockSize)
+      {
+        const int blockSize = std::min(kBlockSize, n - start);
+
+        if (!ReadBytes(block, blockSize * static_cast<int>(sizeof(uint32_t))))
+          return false;
+
+        SwapBlock(block, blockSize);
+
+        for (auto i = 0; i < blockSize; i++)
+        {
+          float f;
+          memcpy(&f, block + i, sizeof(float));
+          pDst[start + i] = f;
+        }
+      }
+
+      return true;
+    }
+
+    /** Read nBytes into a chunk */
+    bool ReadChunk(IByteChunk& chunk, int nBytes)
+    {
+      if (nBytes < 0 || nBytes > mFile.GetSize() - mFile.GetPosition())
+        return false;
+
+      chunk.Resize(nBytes);
+      return ReadBytes(chunk.GetData(), nBytes);
+    }
+
+    /** Read the rest of the file into a chunk */
+    bool ReadRemaining(IByteChunk& chunk)
+    {
+      return ReadChunk(chunk, static_cast<int>(mFile.GetSize() - mFile.GetPosition()));
+    }
+
+  private:
+    WDL_FileRead mFile;
+  };
+
+  /** Convert big endian 32-bit values to native byte order in place. The loop is vectorized to a byte shuffle where one is available (e.g. SSSE3, NEON), otherwise each value is a single bswap */
+  static void SwapBlock(uint32_t* pData, int n)
+  {
+#ifdef WDL_LITTLE_ENDIAN
+    for (auto i = 0; i < n; i++)
+    {
+      const uint32_t v = pData[i];
+      pData[i] = (v >> 24) | ((v >> 8) & 0xff00u) | ((v << 8) & 0xff0000u) | (v << 24);
+    }
+#endif
+  }
+
+  /** Parse the file on the worker thread
+   * @return The result, or nullptr if the file is not valid for the plug-in or the import was cancelled */
+  Result* Parse()
+  {
+    Reader reader(mPath.Get());
+
+    if (!reader.IsOpen())
+      return nullptr;
+
+    Result* pResult = new Result;
+    bool parsedOK = false;
+
+    switch (mFormat)
+    {
+      case kFormatFXP: parsedOK = ParseFXP(reader, *pResult); break;
+      case kFormatFXB: parsedOK = ParseFXB(reader, *pResult); break;
+      case kFormatNativeBank:
+      {
+        pResult->presets.resize(1);
+        Preset& bank = pResult->presets[0];
+        parsedOK = reader.ReadRemaining(bank.state) && ParseNativeBank(bank.state, *pResult);
+        break;
+      }
+    }
+
+    if (!parsedOK || mCancel)
+    {
+      delete pResult;
+      return nullptr;
+    }
+
+    return pResult;
+  }
+
+  /** Read the common part of the FXP and FXB headers, up to the number of parameters or presets */
+  bool ReadHeader(Reader& reader, int32_t& fxMagic, int32_t& version, int32_t& count) const
+  {
+    int32_t chunkMagic, byteSize, pluginID, pluginVersion;
+
+    return reader.ReadBE32(chunkMagic) && reader.ReadBE32(byteSize) && reader.ReadBE32(fxMagic) && reader.ReadBE32(version)
+           && reader.ReadBE32(pluginID) && reader.ReadBE32(pluginVersion) && reader.ReadBE32(count)
+           && chunkMagic == 'CcnK' && pluginID == mPlug->GetUniqueID();
+  }
+
+  /** Read a 28 character program name, which is not null terminated if it is full */
+  static bool ReadProgramName(Reader& reader, Preset& preset)
+  {
+    char name[29] = {};
+
+    if (!reader.ReadBytes(name, 28))
+      return false;
+
+    strncpy(preset.name, name, MAX_PRESET_NAME_LEN - 1);
+    return true;
+  }
+
+  /** Read nParams normalized values, and convert them to non-normalized values, filling any values the file lacks with the defaults */
+  bool ReadNormalizedValues(Reader& reader, int nParams, double* pValues) const
+  {
+    const int nPlugParams = mPlug->NParams();
+    const int nRead = std::min(nParams, nPlugParams);
+
+    if (nParams < 0 || !reader.ReadBEFloats(pValues, nRead))
+      return false;
+
+    for (auto i = 0; i < nPlugParams; i++)
+    {
+      const IParam* pParam = mPlug->GetParam(i);
+      pValues[i] = i < nRead ? pParam->FromNormalized(pValues[i]) : pParam->GetDefault();
+    }
+
+    // Skip any extra values, e.g. from a later version of the plug-in
+    double skipped[kBlockSize];
+
+    for (auto i = nRead; i < nParams; i += kBlockSize)
+    {
+      if (!reader.ReadBEFloats(skipped, std::min(kBlockSize, nParams - i)))
+        return false;
+    }
+
+    return true;
+  }
+
+  bool ParseFXP(Reader& reader, Result& result)
+  {
+    int32_t fxpMagic, fxpVersion, numParams;
+    result.presets.resize(1);
+    Preset& preset = result.presets[0];
+
+    if (!ReadHeader(reader, fxpMagic, fxpVersion, numParams) || fxpVersion != kFXPVersionNum || !ReadProgramName(reader, preset))
+      return false;
+
+    if (mPlug->DoesStateChunks() && fxpMagic == 'FPCh')
+    {
+      int32_t chunkSize;
+
+      if (!reader.ReadBE32(chunkSize) || !reader.ReadChunk(preset.state, chunkSize))
+        return false;
+
+      IByteChunk::GetIPlugVerFromChunk(preset.state, preset.startPos);
+      result.type = kResultState;
+      return true;
+    }
+    else if (fxpMagic == 'FxCk')
+    {
+      result.values.resize(mPlug->NParams());
+      result.type = kResultParams;
+      return ReadNormalizedValues(reader, numParams, result.values.data());
+    }
+
+    return false;
+  }
+
+  bool ParseFXB(Reader& reader, Result& result)
+  {
+    int32_t fxbMagic, fxbVersion, numPgms, currentPgm;
+    char future[124];
+
+    if (!ReadHeader(reader, fxbMagic, fxbVersion, numPgms) || !reader.ReadBE32(currentPgm) || !reader.ReadBytes(future, 124))
+      return false;
+
+    if (mPlug->DoesStateChunks() && fxbMagic == 'FBCh')
+    {
+      int32_t chunkSize;
+      result.presets.resize(1);
+      Preset& bank = result.presets[0];
+
+      return reader.ReadBE32(chunkSize) && reader.ReadChunk(bank.state, chunkSize) && ParseNativeBank(bank.state, result);
+    }
+    else if (fxbMagic == 'FxBk')
+    {
+      const int nParams = mPlug->NParams();
+      const int n = std::min(static_cast<int>(numPgms), mPlug->NPresets());
+      std::vector<double> values(nParams);
+      result.presets.resize(std::max(n, 0));
+
+      for (auto i = 0; i < n && !mCancel; i++)
+      {
+        int32_t fxpMagic, fxpVersion, numParams;
+        Preset& preset = result.presets[i];
+
+        if (!ReadHeader(reader, fxpMagic, fxpVersion, numParams) || fxpMagic != 'FxCk' || fxpVersion != kFXPVersionNum || numParams != nParams
+            || !ReadProgramName(reader, preset) || !ReadNormalizedValues(reader, numParams, values.data()))
+          return false;
+
+        preset.initialized = true;
+
+        // The state is written as the default SerializeParams() would, one double per parameter, otherwise Apply() serializes the plug-in's own state
+        if (mParamsOnly)
+          preset.state.PutBytes(values.data(), nParams * static_cast<int>(sizeof(double)));
+        else
+          preset.values = values;
+      }
+
+      result.type = mParamsOnly ? kResultBank : kResultBankValues;
+      result.currentPreset = currentPgm;
+      return true;
+    }
+
+    return false;
+  }
+
+  /** Split a bank written by SerializePresets() into the preset states, which are then swapped into the plug-in's presets.
+   * If the states may contain custom data, the bank is left whole for UnserializePresets() */
+  bool ParseNativeBank(IByteChunk& bank, Result& result)
+  {
+    int pos = 0;
+    IByteChunk::GetIPlugVerFromChunk(bank, pos);
+
+    if (!mParamsOnly)
+    {
+      result.presets[0].startPos = pos;
+      result.type = kResultRawBank;
+      return true;
+    }
+
+    const int n = mPlug->NPresets();
+    const IByteStream stream(bank.GetData(), bank.Size());
+    std::vector<double> values(mPlug->NParams());
+    std::vector<Preset> presets(n);
+    WDL_String name;
+    int nParsed = 0;
+
+    for (; nParsed < n && pos >= 0 && !mCancel; nParsed++)
+    {
+      Preset& preset = presets[nParsed];
+      pos = bank.GetStr(name, pos);
+
+      if (pos < 0)
+        break;
+
+      strncpy(preset.name, name.Get(), MAX_PRESET_NAME_LEN - 1);
+      pos = bank.Get(&preset.initialized, pos);
+
+      if (pos >= 0 && preset.initialized)
+      {
+        const int endPos = mPlug->ReadParamValues(stream, pos, values.data());
+
+        if (endPos < 0)
+          return false;
+
+        preset.state.PutBytes(bank.GetData() + pos, endPos - pos);
+        pos = endPos;
+      }
+    }
+
+    // Presets missing from the end of a shorter bank are left as they are
+    presets.resize(nParsed);
+    result.presets.swap(presets);
+    result.type = kResultBank;
+    return nParsed > 0;
+  }
+
+  const IPluginBase* mPlug = nullptr;
+  WDL_String mPath;
+  EFormat mFormat = kFormatFXP;
+  bool mParamsOnly = false;
+  std::thread mWorker;
+  std::atomic<bool> mCancel {false};
+  std::atomic<EStatus> mStatus {kStatusIdle};
+  /** The finished result, owned by whoever exchanges it out */
+  std::atomic<Result*> mReady {nullptr};
+};
+
+END_IPLUG_NAMESPACE
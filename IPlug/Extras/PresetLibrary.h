@@ -0,0 +1,346 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @brief A read-only preset library backed by a single memory-mapped file, shared by every plug-in instance in the process
+ *
+ * Unlike IPluginBase's presets, which each own an IByteChunk in RAM, a library keeps every preset's state in one file that is mapped into memory,
+ * so the operating system pages in only the presets that are used, and the pages are shared between instances (and processes).
+ * Presets are indexed by name, category and tag when the library is opened, and are only decoded when they are restored:
+ *
+ * std::shared_ptr<const PresetLibrary> lib = PresetLibrary::Open(path.Get());
+ * int idx = lib->FindPreset("Warm Pad");
+ * lib->RestoreChangedParams(*this, idx);
+ *
+ * A library file is built with PresetLibrary::Write(), e.g. by a tool or a debug build of the plug-in, from states made with SerializeState().
+ * The file is written in the native byte order, like other iPlug state.
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "IPlugPlatform.h"
+#include "IPlugPluginBase.h"
+#include "fileread.h"
+
+#define IPLUG_PRESET_LIBRARY_MAGIC 'plib'
+#define IPLUG_PRESET_LIBRARY_VERSION 1
+
+BEGIN_IPLUG_NAMESPACE
+
+class PresetLibrary
+{
+public:
+  /** Describes one preset when writing a library */
+  struct Entry
+  {
+    const char* name;
+    const char* category;
+    /** Comma separated tags, e.g. "dark,evolving" */
+    const char* tags;
+    /** The preset's state, as written by SerializeState() */
+    const IByteChunk* pState;
+  };
+
+  /** Open a library file, or get the library that is already open in this process. The file is mapped read-only and must not be modified while it is open
+   * @param path The full path to the library file
+   * @return The shared library, or nullptr if the file could not be read or is not a valid library */
+  static std::shared_ptr<const PresetLibrary> Open(const char* path)
+  {
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::weak_ptr<const PresetLibrary>> libraries;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::weak_ptr<const PresetLibrary>& entry = libraries[path];
+    std::shared_ptr<const PresetLibrary> library = entry.lock();
+
+    if (!library)
+    {
+      std::shared_ptr<PresetLibrary> newLibrary(new PresetLibrary(path));
+
+      if (!newLibrary->mIndex)
+      {
+        libraries.erase(path);
+        return nullptr;
+      }
+
+      library = newLibrary;
+      entry = library;
+    }
+
+    return library;
+  }
+
+  /** Write a library file
+   * @param path The full path to the file, which is overwritten
+   * @param entries The presets
+   * @return \c true on success */
+  static bool Write(const char* path, const std::vector<Entry>& entries)
+  {
+    const int nPresets = static_cast<int>(entries.size());
+    std::vector<IndexEntry> index(nPresets);
+    IByteChunk strings, data;
+    const char padding[8] = {};
+
+    auto putStr = [&strings](const char* str) {
+      const int offset = strings.Size();
+      strings.PutBytes(str ? str : "", static_cast<int>(strlen(str ? str : "")) + 1);
+      return offset;
+    };
+
+    for (auto i = 0; i < nPresets; i++)
+    {
+      const Entry& entry = entries[i];
+
+      // Each preset's data starts on an 8-byte boundary
+      data.PutBytes(padding, -data.Size() & 7);
+
+      index[i].nameOffset = putStr(entry.name);
+      index[i].categoryOffset = putStr(entry.category);
+      index[i].tagsOffset = putStr(entry.tags);
+      index[i].dataOffset = data.Size();
+      index[i].dataSize = entry.pState ? entry.pState->Size() : 0;
+
+      if (entry.pState)
+        data.PutChunk(entry.pState);
+    }
+
+    // Offsets in the file are from its start. The data region starts on an 8-byte boundary too, so every preset's values can be read in place
+    const int stringsPos = static_cast<int>(sizeof(Header) + nPresets * sizeof(IndexEntry));
+    const int dataPos = (stringsPos + strings.Size() + 7) & ~7;
+
+    for (auto& indexEntry : index)
+    {
+      indexEntry.nameOffset += stringsPos;
+      indexEntry.categoryOffset += stringsPos;
+      indexEntry.tagsOffset += stringsPos;
+      indexEntry.dataOffset += dataPos;
+    }
+
+    Header header {IPLUG_PRESET_LIBRARY_MAGIC, IPLUG_PRESET_LIBRARY_VERSION, nPresets, dataPos + data.Size()};
+
+    FILE* fp = fopen(path, "wb");
+
+    if (!fp)
+      return false;
+
+    bool writtenOK = fwrite(&header, sizeof(Header), 1, fp) == 1;
+    writtenOK &= nPresets == 0 || fwrite(index.data(), sizeof(IndexEntry), nPresets, fp) == static_cast<size_t>(nPresets);
+    writtenOK &= fwrite(strings.GetData(), 1, strings.Size(), fp) == static_cast<size_t>(strings.Size());
+    writtenOK &= fwrite(padding, 1, dataPos - stringsPos - strings.Size(), fp) == static_cast<size_t>(dataPos - stringsPos - strings.Size());
+    writtenOK &= fwrite(data.GetData(), 1, data.Size(), fp) == static_cast<size_t>(data.Size());
+    fclose(fp);
+
+    return writtenOK;
+  }
+
+  /** @return The number of presets in the library */
+  int NPresets() const { return mNPresets; }
+
+  /** @return The name of a preset */
+  const char* GetName(int idx) const { return GetString(mIndex[idx].nameOffset); }
+
+  /** @return The category of a preset, or an empty string */
+  const char* GetCategory(int idx) const { return GetString(mIndex[idx].categoryOffset); }
+
+  /** @return The comma separated tags of a preset, or an empty string */
+  const char* GetTags(int idx) const { return GetString(mIndex[idx].tagsOffset); }
+
+  /** Find a preset by name, using the name index
+   * @return The index of the first preset with the name, or -1 if there is none */
+  int FindPreset(const char* name) const
+  {
+    const uint32_t hash = IParam::StableIDFromName(name);
+    auto it = std::lower_bound(mNameIndex.begin(), mNameIndex.end(), std::make_pair(hash, 0));
+
+    for (; it != mNameIndex.end() && it->first == hash; ++it)
+    {
+      if (!strcmp(GetName(it->second), name))
+        return it->second;
+    }
+
+    return -1;
+  }
+
+  /** @return The unique categories, in the order they first appear */
+  const std::vector<std::string>& GetCategories() const { return mCategories; }
+
+  /** @return The indexes of the presets in a category, in library order */
+  const std::vector<int>& GetPresetsInCategory(const char* category) const { return Lookup(mCategoryIndex, category); }
+
+  /** @return The indexes of the presets with a tag, in library order */
+  const std::vector<int>& GetPresetsWithTag(const char* tag) const { return Lookup(mTagIndex, tag); }
+
+  /** Get a preset's state, without copying it. The data stays valid for as long as the library is alive
+   * @return A stream over the state, as written by SerializeState() */
+  IByteStream GetPresetData(int idx) const
+  {
+    return IByteStream(mData + mIndex[idx].dataOffset, mIndex[idx].dataSize);
+  }
+
+  /** Restore a preset through the plug-in's UnserializeState(), which supports custom state. The state is copied into an IByteChunk, as UnserializeState() requires
+   * @return \c true on success */
+  bool RestorePreset(IPluginBase& plug, int idx) const
+  {
+    if (idx < 0 || idx >= mNPresets)
+      return false;
+
+    const IByteStream stream = GetPresetData(idx);
+    IByteChunk chunk;
+    chunk.PutBytes(stream.GetData(), stream.Size());
+
+    if (plug.UnserializeState(chunk, 0) < 0)
+      return false;
+
+    plug.OnRestoreState();
+    return true;
+  }
+
+  /** Restore only the parameters whose values differ from the plug-in's current values, see IPluginBase::UnserializeChangedParams().
+   * This reads the mapped data in place, and requires that the preset states contain only parameters, as written by the default SerializeState()
+   * @return \c true on success */
+  bool RestoreChangedParams(IPluginBase& plug, int idx) const
+  {
+    if (idx < 0 || idx >= mNPresets)
+      return false;
+
+    return plug.UnserializeChangedParams(GetPresetData(idx), 0) >= 0;
+  }
+
+private:
+  struct Header
+  {
+    int32_t magic;
+    int32_t version;
+    int32_t nPresets;
+    int32_t fileSize;
+  };
+
+  struct IndexEntry
+  {
+    int32_t nameOffset;
+    int32_t categoryOffset;
+    int32_t tagsOffset;
+    int32_t dataOffset;
+    int32_t dataSize;
+  };
+
+  explicit PresetLibrary(const char* path)
+  : mFile(path, 0, 8192, 4, 1, INT_MAX)
+  {
+    if (!mFile.IsOpen() || mFile.GetSize() < static_cast<WDL_FILEREAD_POSTYPE>(sizeof(Header)))
+      return;
+
+    int size = static_cast<int>(mFile.GetSize());
+    const uint8_t* pData = static_cast<const uint8_t*>(mFile.GetMappedView(0, &size));
+
+    Header header;
+
+    if (!pData || size < static_cast<int>(sizeof(Header)))
+      return;
+
+    memcpy(&header, pData, sizeof(Header));
+
+    if (header.magic != IPLUG_PRESET_LIBRARY_MAGIC || header.version > IPLUG_PRESET_LIBRARY_VERSION || header.nPresets < 0
+        || header.fileSize > size || header.nPresets > (size - static_cast<int>(sizeof(Header))) / static_cast<int>(sizeof(IndexEntry)))
+      return;
+
+    const IndexEntry* pIndex = reinterpret_cast<const IndexEntry*>(pData + sizeof(Header));
+
+    for (auto i = 0; i < header.nPresets; i++)
+    {
+      const IndexEntry& entry = pIndex[i];
+
+      if (!IsValidString(pData, size, entry.nameOffset) || !IsValidString(pData, size, entry.categoryOffset) || !IsValidString(pData, size, entry.tagsOffset)
+          || entry.dataOffset < 0 || entry.dataSize < 0 || entry.dataSize > size - entry.dataOffset)
+        return;
+    }
+
+    mData = pData;
+    mNPresets = header.nPresets;
+    BuildIndexes(pIndex);
+    mIndex = pIndex;
+  }
+
+  static bool IsValidString(const uint8_t* pData, int size, int offset)
+  {
+    return offset >= 0 && offset < size && memchr(pData + offset, 0, size - offset);
+  }
+
+  const char* GetString(int offset) const { return reinterpret_cast<const char*>(mData + offset); }
+
+  /** Index the names by hash, and the categories and tags by string. Only offsets and indexes are stored, the strings themselves stay in the mapped file */
+  void BuildIndexes(const IndexEntry* pIndex)
+  {
+    mNameIndex.reserve(mNPresets);
+
+    for (auto i = 0; i < mNPresets; i++)
+    {
+      mNameIndex.emplace_back(IParam::StableIDFromName(GetString(pIndex[i].nameOffset)), i);
+
+      const char* category = GetString(pIndex[i].categoryOffset);
+
+      if (*category)
+      {
+        std::vector<int>& presets = mCategoryIndex[category];
+
+        if (presets.empty())
+          mCategories.emplace_back(category);
+
+        presets.push_back(i);
+      }
+
+      for (const char* tag = GetString(pIndex[i].tagsOffset); *tag;)
+      {
+        while (*tag == ' ')
+          tag++;
+
+        const char* end = strchr(tag, ',');
+        const size_t len = end ? end - tag : strlen(tag);
+
+        if (len)
+          mTagIndex[std::string(tag, len)].push_back(i);
+
+        tag += len + (end ? 1 : 0);
+      }
+    }
+
+    std::sort(mNameIndex.begin(), mNameIndex.end());
+  }
+
+  static const std::vector<int>& Lookup(const std::unordered_map<std::string, std::vector<int>>& index, const char* key)
+  {
+    static const std::vector<int> empty;
+    auto it = index.find(key);
+    return it != index.end() ? it->second : empty;
+  }
+
+  WDL_FileRead mFile;
+  const uint8_t* mData = nullptr;
+  const IndexEntry* mIndex = nullptr;
+  int mNPresets = 0;
+  std::vector<std::pair<uint32_t, int>> mNameIndex;
+  std::vector<std::string> mCategories;
+  std::unordered_map<std::string, std::vector<int>> mCategoryIndex;
+  std::unordered_map<std::string, std::vector<int>> mTagIndex;
+};
+
+END_IPLUG_NAMESPACE
@@ -0,0 +1,341 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @brief Realtime morphing between 2 to MAXPRESETS parameter states, from a single macro value
+ *
+ * The presets are analysed on the main thread: their values are normalized with IParam::ToNormalized(), and for each adjacent pair the parameters that differ
+ * are listed, split into continuous parameters (kTypeDouble, kTypeInt), which are interpolated, and discrete ones (kTypeBool, kTypeEnum), which switch at a threshold.
+ * The result is handed to the audio thread through a lock-free queue, so Process() neither allocates nor locks:
+ *
+ * // main thread
+ * mMorpher.SetMacroParam(kMorph);
+ * mMorpher.SetPresets(*this, states, 3);
+ * // ProcessBlock()
+ * mMorpher.Process(*this, GetParam(kMorph)->Value(), nFrames, [&](int paramIdx) { OnParamChange(paramIdx, kPresetRecall); });
+ *
+ * Morphed values are written to the IParams, so parameter smoothing set with IParam::SetSmoothing() applies to them. The macro parameter, and any set with SetExcludedParams(),
+ * are never written, so a preset can't move the control that drives the morph. NOTE: the host and UI are not informed of morphed values
+ */
+
+#include <cmath>
+#include <initializer_list>
+#include <vector>
+
+#include "IPlugPlatform.h"
+#include "IPlugPluginBase.h"
+#include "IPlugQueue.h"
+#include "IPlugUtilities.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+template <int MAXPRESETS = 4>
+class PresetMorpher
+{
+  static_assert(MAXPRESETS >= 2, "PresetMorpher needs at least two presets");
+
+public:
+  PresetMorpher()
+  : mPending(kQueueSize)
+  , mRetired(kQueueSize)
+  {
+  }
+
+  ~PresetMorpher()
+  {
+    FreeRetiredSnapshots();
+
+    Snapshot* pSnapshot = nullptr;
+
+    while (mPending.Pop(pSnapshot))
+      delete pSnapshot;
+
+    delete mActive;
+  }
+
+  PresetMorpher(const PresetMorpher&) = delete;
+  PresetMorpher& operator=(const PresetMorpher&) = delete;
+
+  /** Set the presets to morph between from their states. Call this on the main thread
+   * @param plug The plug-in, used to decode the states with IPluginBase::ReadParamValues(), so the states must contain only parameters, as written by the default SerializeState()
+   * @param pStates nPresets states, in morph order
+   * @param nPresets The number of presets, from 2 to MAXPRESETS
+   * @return \c true if the presets were decoded and queued for the audio thread */
+  bool SetPresets(const IPluginBase& plug, const IByteStream* pStates, int nPresets)
+  {
+    if (nPresets < 2 || nPresets > MAXPRESETS)
+      return false;
+
+    const int nParams = plug.NParams();
+    std::vector<double> values(nPresets * nParams);
+    const double* pValues[MAXPRESETS];
+
+    for (auto p = 0; p < nPresets; p++)
+    {
+      if (plug.ReadParamValues(pStates[p], 0, values.data() + p * nParams) < 0)
+        return false;
+
+      pValues[p] = values.data() + p * nParams;
+    }
+
+    return SetPresetValues(plug, pValues, nPresets);
+  }
+
+  /** Set the presets to morph between from non-normalized parameter values. Call this on the main thread
+   * @param plug The plug-in
+   * @param pValues nPresets pointers, each to NParams() values, in morph order
+   * @param nPresets The number of presets, from 2 to MAXPRESETS
+   * @return \c true if the presets were queued for the audio thread */
+  bool SetPresetValues(const IPluginBase& plug, const double* const* pValues, int nPresets)
+  {
+    if (nPresets < 2 || nPresets > MAXPRESETS)
+      return false;
+
+    FreeRetiredSnapshots();
+
+    const int nParams = plug.NParams();
+    Snapshot* pSnapshot = new Snapshot;
+    pSnapshot->nPresets = nPresets;
+    pSnapshot->normalized.resize(nPresets * nParams);
+    pSnapshot->discrete.resize(nParams);
+    pSnapshot->thresholds.resize(nParams);
+    pSnapshot->continuous.resize(nPresets - 1);
+    pSnapshot->switched.resize(nPresets - 1);
+    pSnapshot->morphed.reserve(nParams);
+
+    for (auto i = 0; i < nParams; i++)
+    {
+      const IParam* pParam = plug.GetParam(i);
+
+      if (!IsExcluded(i))
+        pSnapshot->morphed.push_back(i);
+
+      pSnapshot->discrete[i] = pParam->Type() == IParam::kTypeBool || pParam->Type() == IParam::kTypeEnum;
+      pSnapshot->thresholds[i] = i < static_cast<int>(mParamThresholds.size()) && mParamThresholds[i] >= 0. ? mParamThresholds[i] : mThreshold;
+
+      for (auto p = 0; p < nPresets; p++)
+        pSnapshot->normalized[p * nParams + i] = pParam->ToNormalized(pValues[p][i]);
+    }
+
+    // List the parameters that change across each segment, so that Process() skips those that are the same in both presets
+    for (auto s = 0; s < nPresets - 1; s++)
+    {
+      for (auto i : pSnapshot->morphed)
+      {
+        if (pSnapshot->normalized[s * nParams + i] != pSnapshot->normalized[(s + 1) * nParams + i])
+          (pSnapshot->discrete[i] ? pSnapshot->switched[s] : pSnapshot->continuous[s]).push_back(i);
+      }
+    }
+
+    if (!mPending.Push(pSnapshot))
+    {
+      delete pSnapshot;
+      return false;
+    }
+
+    return true;
+  }
+
+  /** Set the parameter that drives the morph, which is never morphed itself. Call this before SetPresets()
+   * @param paramIdx The macro parameter, or -1 for none */
+  void SetMacroParam(int paramIdx)
+  {
+    mMacroParam = paramIdx;
+  }
+
+  /** Set parameters that keep their current values when morphing, e.g. output gain. Call this before SetPresets()
+   * @param paramIdxs The parameters, replacing any set before */
+  void SetExcludedParams(std::initializer_list<int> paramIdxs)
+  {
+    mExcluded.clear();
+
+    for (auto paramIdx : paramIdxs)
+    {
+      if (paramIdx < 0)
+        continue;
+
+      if (paramIdx >= static_cast<int>(mExcluded.size()))
+        mExcluded.resize(paramIdx + 1, false);
+
+      mExcluded[paramIdx] = true;
+    }
+  }
+
+  /** Set the smoothing applied to the macro value
+   * @param timeMs The time constant in milliseconds, 0 for no smoothing
+   * @param sampleRate The sample rate */
+  void SetSmoothingTime(double timeMs, double sampleRate)
+  {
+    mSmoothingSamples = timeMs * 0.001 * sampleRate;
+  }
+
+  /** Set the position within a segment at which discrete parameters switch to the next preset's value. Call this before SetPresets()
+   * @param threshold The position, from 0 to 1 */
+  void SetDiscreteThreshold(double threshold)
+  {
+    mThreshold = Clip(threshold, 0., 1.);
+    mParamThresholds.clear();
+  }
+
+  /** Set the switching position for one discrete parameter, overriding SetDiscreteThreshold(). Call this before SetPresets()
+   * @param paramIdx The parameter
+   * @param threshold The position, from 0 to 1 */
+  void SetDiscreteThreshold(int paramIdx, double threshold)
+  {
+    if (paramIdx >= static_cast<int>(mParamThresholds.size()))
+      mParamThresholds.resize(paramIdx + 1, -1.);
+
+    mParamThresholds[paramIdx] = Clip(threshold, 0., 1.);
+  }
+
+  /** Morph the parameters of the plug-in. This is realtime safe, call it from ProcessBlock()
+   * @param plug The plug-in
+   * @param macro The morph position, 0 for the first preset, 1 for the last, with the others evenly spaced in between
+   * @param nFrames The number of frames in the block, by which the macro smoothing advances
+   * @param onChanged A callable with the signature void(int paramIdx), called for each parameter whose value was set, e.g. to update the DSP */
+  template <typename F>
+  void Process(IEditorDelegate& plug, double macro, int nFrames, F&& onChanged)
+  {
+    const bool update = ReceiveSnapshot();
+
+    if (!mActive)
+      return;
+
+    const double target = Clip(macro, 0., 1.);
+
+    // The macro starts at its target, and keeps smoothing when the presets are replaced
+    if (mSmoothingSamples > 0. && mAppliedSegment >= 0)
+      mMacro += (target - mMacro) * (1. - std::exp(-nFrames / mSmoothingSamples));
+    else
+      mMacro = target;
+
+    if (!update && std::fabs(mMacro - mAppliedMacro) < 1e-7)
+      return;
+
+    const Snapshot& snapshot = *mActive;
+    const int nParams = static_cast<int>(snapshot.discrete.size());
+    const double pos = mMacro * (snapshot.nPresets - 1);
+    const int segment = std::min(static_cast<int>(pos), snapshot.nPresets - 2);
+    const double frac = pos - segment;
+    const double* pA = snapshot.normalized.data() + segment * nParams;
+    const double* pB = pA + nParams;
+
+    auto apply = [&](int paramIdx) {
+      const double value = snapshot.discrete[paramIdx] ? (frac >= snapshot.thresholds[paramIdx] ? pB[paramIdx] : pA[paramIdx])
+                                                       : pA[paramIdx] + frac * (pB[paramIdx] - pA[paramIdx]);
+      IParam* pParam = plug.GetParam(paramIdx);
+      const double prev = pParam->Value();
+      pParam->SetNormalized(value);
+
+      if (pParam->Value() != prev)
+        onChanged(paramIdx);
+    };
+
+    // Within a segment only the parameters that differ need setting, on entering a segment every morphed parameter is set
+    if (update || segment != mAppliedSegment)
+    {
+      for (auto i : snapshot.morphed)
+        apply(i);
+    }
+    else
+    {
+      for (auto i : snapshot.continuous[segment])
+        apply(i);
+
+      for (auto i : snapshot.switched[segment])
+        apply(i);
+    }
+
+    mAppliedMacro = mMacro;
+    mAppliedSegment = segment;
+  }
+
+  /** Morph the parameters of the plug-in, without a change callback */
+  void Process(IEditorDelegate& plug, double macro, int nFrames)
+  {
+    Process(plug, macro, nFrames, [](int) {});
+  }
+
+private:
+  static constexpr int kQueueSize = 8;
+
+  /** The presets as analysed on the main thread, which is immutable once queued */
+  struct Snapshot
+  {
+    int nPresets = 0;
+    /** nPresets * nParams normalized values */
+    std::vector<double> normalized;
+    std::vector<bool> discrete;
+    /** The parameters that are morphed, which excludes the macro parameter and SetExcludedParams() */
+    std::vector<int> morphed;
+    /** The switching position of each discrete parameter */
+    std::vector<double> thresholds;
+    /** For each segment between adjacent presets, the continuous parameters that differ */
+    std::vector<std::vector<int>> continuous;
+    /** For each segment between adjacent presets, the discrete parameters that differ */
+    std::vector<std::vector<int>> switched;
+  };
+
+  /** Take the newest snapshot from the main thread, passing older ones back to be freed there.
+   * If there is no room to retire the active snapshot, it is kept and the rest are taken on a later block
+   * @return \c true if there is a new snapshot */
+  bool ReceiveSnapshot()
+  {
+    bool received = false;
+
+    while (!mPending.WasEmpty())
+    {
+      if (mActive)
+      {
+        if (!mRetired.Push(mActive))
+          break;
+
+        mActive = nullptr;
+      }
+
+      mPending.Pop(mActive);
+      received = true;
+    }
+
+    return received;
+  }
+
+  bool IsExcluded(int paramIdx) const
+  {
+    return paramIdx == mMacroParam || (paramIdx < static_cast<int>(mExcluded.size()) && mExcluded[paramIdx]);
+  }
+
+  void FreeRetiredSnapshots()
+  {
+    Snapshot* pSnapshot = nullptr;
+
+    while (mRetired.Pop(pSnapshot))
+      delete pSnapshot;
+  }
+
+  IPlugQueue<Snapshot*> mPending;
+  IPlugQueue<Snapshot*> mRetired;
+  Snapshot* mActive = nullptr;
+  double mThreshold = 0.5;
+  /** Per parameter thresholds, or -1 to use mThreshold. Only used on the main thread */
+  std::vector<double> mParamThresholds;
+  /** The parameter that drives the morph, and the parameters that keep their values. Only used on the main thread */
+  int mMacroParam = -1;
+  std::vector<bool> mExcluded;
+  double mSmoothingSamples = 0.;
+  double mMacro = 0.;
+  double mAppliedMacro = -1.;
+  int mAppliedSegment = -1;
+};
+
+END_IPLUG_NAMESPACE
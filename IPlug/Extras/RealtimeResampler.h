@@ -35,7 +35,7 @@ BEGIN_IPLUG_NAMESPACE
  * when T==float.
  *
  * @tparam T the sampletype float or double
- * @tparam NCHANS the number of channels
+ * @tparam NCHANS the default number of channels, which can be overridden at construction
  * @tparam A The Lanczos filter size for the LanczosResampler resampler mode
  * A higher value makes the filter closer to an ideal stop-band that rejects high-frequency
  * content (anti-aliasing), but at the expense of higher latency
@@ -59,10 +59,12 @@ public:
   /** Constructor
    * @param innerSampleRate The sample rate that the provided DSP block will process at
    * @param mode The sample rate conversion mode
+   * @param nChans The number of channels, e.g. for a surround bus
    */
-  RealtimeResampler(double innerSampleRate, ESRCMode mode = ESRCMode::kLancsoz)
+  RealtimeResampler(double innerSampleRate, ESRCMode mode = ESRCMode::kLancsoz, int nChans = NCHANS)
   : mResamplingMode(mode)
   , mInnerSampleRate(innerSampleRate)
+  , mNChans(nChans)
   {
   }
   
@@ -81,12 +83,12 @@ public:
     mMaxOuterLength = maxBlockSize;
     mMaxInnerLength = CalculateMaxInnerLength(mMaxOuterLength);
 
-    mInputData.Resize(mMaxInnerLength * NCHANS);
-    mOutputData.Resize(mMaxInnerLength * NCHANS);
+    mInputData.Resize(mMaxInnerLength * mNChans);
+    mOutputData.Resize(mMaxInnerLength * mNChans);
     mInputPtrs.Empty();
     mOutputPtrs.Empty();
     
-    for (auto chan=0; chan<NCHANS; chan++)
+    for (auto chan=0; chan<mNChans; chan++)
     {
       mInputPtrs.Add(mInputData.Get() + (chan * mMaxInnerLength));
       mOutputPtrs.Add(mOutputData.Get() + (chan * mMaxInnerLength));
@@ -98,16 +100,18 @@ public:
     {
       const T outerRate = static_cast<T>(mOuterSampleRate);
       const T innerRate = static_cast<T>(mInnerSampleRate);
-      mInResampler = std::make_unique<LanczosResampler>(outerRate, innerRate);
-      mOutResampler = std::make_unique<LanczosResampler>(innerRate, outerRate);
+      // Size the resampler history for the largest blocks either side will push, rather than a fixed size, to keep it small enough to stay in cache
+      const size_t bufferSize = 2 * (std::max(mMaxOuterLength, mMaxInnerLength) + 2 * A + 2);
+      mInResampler = std::make_unique<LanczosResampler>(outerRate, innerRate, mNChans, bufferSize);
+      mOutResampler = std::make_unique<LanczosResampler>(innerRate, outerRate, mNChans, bufferSize);
       
       // Warm up the resamplers with enough silence that the first real buffer can yield the required number of output samples.
       const auto outSamplesRequired = mOutResampler->GetNumSamplesRequiredFor(1);
       const auto inSamplesRequired = mInResampler->GetNumSamplesRequiredFor(outSamplesRequired);
-      mInResampler->PushBlock(mInputPtrs.GetList(), inSamplesRequired, NCHANS);
-      const auto populated = mInResampler->PopBlock(mInputPtrs.GetList(), outSamplesRequired, NCHANS);
+      mInResampler->PushBlock(mInputPtrs.GetList(), inSamplesRequired, mNChans);
+      const auto populated = mInResampler->PopBlock(mInputPtrs.GetList(), outSamplesRequired, mNChans);
       assert(populated >= outSamplesRequired && "Didn't get enough samples required for warm up!");
-      mOutResampler->PushBlock(mOutputPtrs.GetList(), populated, NCHANS);
+      mOutResampler->PushBlock(mOutputPtrs.GetList(), populated, mNChans);
       
       // magic number that we seem to need to align when compensating for latency
       constexpr auto addedLatency = 2;
@@ -123,9 +127,10 @@ public:
    * @param inputs Two-dimensional array containing the non-interleaved input buffers of audio samples for all channels
    * @param outputs Two-dimensional array for audio output (non-interleaved).
    * @param nFrames The block size for this block: number of samples per channel.
-   * @param func The function that processes the audio sample at the higher sampling rate. 
-   * NOTE: std::function can call malloc if you pass in captures */
-  void ProcessBlock(T** inputs, T** outputs, int nFrames, int nChans, BlockProcessFunc func)
+   * @param func The function that processes the audio sample at the inner sampling rate, any callable with the signature void(T**, T**, int, int), e.g. a lambda or a SerialChain.
+   * It is called directly, so it can be inlined and captures never allocate, unlike when passing a BlockProcessFunc (std::function) */
+  template <typename F>
+  void ProcessBlock(T** inputs, T** outputs, int nFrames, int nChans, F&& func)
   {
     if (mInnerSampleRate == mOuterSampleRate) // nothing to do!
     {
@@ -172,6 +177,9 @@ public:
   
   /** Get the latency of the resampling, not including any latency of the encapsulated DSP */
   int GetLatency() const { return mLatency; }
+  
+  /** @return The number of channels the resampler was constructed for */
+  int NChans() const { return mNChans; }
 
 private:
   /** Interpolate the signal across the block with a specific resampling ratio */
@@ -206,7 +214,7 @@ private:
   /** Zero the memory in the scratch buffers */
   void ClearBuffers()
   {
-    const auto nBytes = mMaxInnerLength * NCHANS * sizeof(T);
+    const auto nBytes = mMaxInnerLength * mNChans * sizeof(T);
     memset(mInputData.Get(), 0, nBytes);
     memset(mOutputData.Get(), 0, nBytes);
   }
@@ -226,6 +234,7 @@ private:
   int mMaxInnerLength = 0; // The computed maximum inner block size
   int mLatency = 0;
   const ESRCMode mResamplingMode;
+  const int mNChans;
   std::unique_ptr<LanczosResampler> mInResampler, mOutResampler;
 } WDL_FIXALIGN;
 
@@ -121,6 +121,95 @@ public:
     }
   }
 
+  /** Process a block with the cutoff frequency and Q supplied per sample, e.g. written by ControlRamp::Write() or an LFO, so that the filter can be modulated at audio rate.
+   * Coefficients are calculated every sample using FastTan(), and the channels (or voices) are processed together in the inner loop, in precision T, so that the compiler can vectorize across them.
+   * The mode, gain and sample rate are picked up at the start of the block.
+   * @param inputs The input buffers
+   * @param outputs The output buffers
+   * @param freqCPS Per channel buffers of cutoff frequencies in Hz. The same buffer may be passed for several channels
+   * @param Q Per channel buffers of Q values, or nullptr to use the value set with SetQ()
+   * @param nChans The number of channels to process, which must be <= NC
+   * @param nFrames The number of sample frames to process */
+  void ProcessBlock(T** inputs, T** outputs, T** freqCPS, T** Q, int nChans, int nFrames)
+  {
+    assert(nChans <= NC);
+
+    if(mState != mNewState)
+      UpdateCoefficients();
+
+    // Every mode mixes as m0 * v0 + (m1 + mk * k) * v1 + m2 * v2, so the mode can be resolved once per block
+    const double A = std::pow(10., mState.gain/40.);
+    double gScale = 1., m0 = 0., m1 = 0., mk = 0., m2 = 0.;
+
+    switch(mState.mode)
+    {
+      case kLowPass: m2 = 1.; break;
+      case kHighPass: m0 = 1.; mk = -1.; m2 = -1.; break;
+      case kBandPass: m1 = 1.; break;
+      case kNotch: m0 = 1.; mk = -1.; break;
+      case kPeak: m0 = 1.; mk = -1.; m2 = -2.; break;
+      case kBell: m0 = 1.; mk = A * A - 1.; break;
+      case kLowPassShelf: gScale = 1. / std::sqrt(A); m0 = 1.; mk = A - 1.; m2 = A * A - 1.; break;
+      case kHighPassShelf: gScale = 1. / std::sqrt(A); m0 = A * A; mk = (1. - A) * A; m2 = 1. - A * A; break;
+      default: break;
+    }
+
+    const T wScale = static_cast<T>(PI / mState.sampleRate);
+    const T minFreq = static_cast<T>(10.);
+    const T maxFreq = static_cast<T>(std::min(20000., 0.49 * mState.sampleRate));
+    const T fixedK = static_cast<T>(1. / mState.Q);
+
+    T ic1eq[NC];
+    T ic2eq[NC];
+
+    for (auto c = 0; c < nChans; c++)
+    {
+      ic1eq[c] = static_cast<T>(mIc1eq[c]);
+      ic2eq[c] = static_cast<T>(mIc2eq[c]);
+    }
+
+    for (auto s = 0; s < nFrames; s++)
+    {
+      for (auto c = 0; c < nChans; c++)
+      {
+        const T freq = Clip(freqCPS[c][s], minFreq, maxFreq);
+        const T k = Q ? T(1) / Clip(Q[c][s], static_cast<T>(0.1), static_cast<T>(100.)) : fixedK;
+        const T g = FastTan(wScale * freq) * static_cast<T>(gScale);
+        const T a1 = T(1) / (T(1) + g * (g + k));
+        const T a2 = g * a1;
+        const T a3 = g * a2;
+
+        const T v0 = inputs[c][s];
+        const T v3 = v0 - ic2eq[c];
+        const T v1 = a1 * ic1eq[c] + a2 * v3;
+        const T v2 = ic2eq[c] + a2 * ic1eq[c] + a3 * v3;
+        ic1eq[c] = T(2) * v1 - ic1eq[c];
+        ic2eq[c] = T(2) * v2 - ic2eq[c];
+
+        outputs[c][s] = static_cast<T>(m0) * v0 + (static_cast<T>(m1) + static_cast<T>(mk) * k) * v1 + static_cast<T>(m2) * v2;
+      }
+    }
+
+    for (auto c = 0; c < nChans; c++)
+    {
+      mIc1eq[c] = static_cast<double>(ic1eq[c]);
+      mIc2eq[c] = static_cast<double>(ic2eq[c]);
+    }
+  }
+
+  /** Fast approximation of tan(x) for x in [0, pi/2), used to prewarp modulated cutoff frequencies.
+   * A [5/4] Pade approximant on [0, pi/4], mirrored with tan(x) = 1/tan(pi/2 - x) above that, has a relative error below 2e-8.
+   * The branches are selects, so calls vectorize */
+  static inline T FastTan(T x)
+  {
+    const T quarterPi = static_cast<T>(PI / 4.);
+    const bool mirror = x > quarterPi;
+    const T r = mirror ? static_cast<T>(PI / 2.) - x : x;
+    const T r2 = r * r;
+    const T t = r * (T(945) - r2 * (T(105) - r2)) / (T(945) - r2 * (T(420) - T(15) * r2));
+    return mirror ? T(1) / t : t;
+  }
+
   void Reset()
   {
     for (auto c = 0; c < NC; c++)
@@ -0,0 +1,200 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * @brief A registry of immutable DSP assets (tables, impulse responses, samples), shared by every plug-in instance in the module
+ *
+ * Assets are keyed by their type, a hash of the content they are made from, and the sample rate they were prepared for.
+ * The first instance to ask for an asset creates it, instances asking for the same key at the same time wait for it, and later instances get the same memory:
+ *
+ * const uint64_t hash = SharedAssets::HashContent(pIRData, irSize * sizeof(float));
+ * std::shared_ptr<const IR> ir = SharedAssets::Get<IR>(hash, sampleRate, [&]() { return std::unique_ptr<IR>(new IR(pIRData, irSize, sampleRate)); });
+ *
+ * The registry only holds weak references, so an asset is freed, and its entry removed, when the last shared_ptr to it goes away. NOTE: that happens on the thread
+ * that releases the last reference, so don't release assets on the audio thread. Each plug-in binary has its own registry
+ */
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include <unordered_map>
+
+#include "IPlugPlatform.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+class SharedAssets
+{
+public:
+  /** @return The 64-bit FNV-1a hash of a block of memory, to use as the content hash of an asset made from it
+   * @param pData The data
+   * @param nBytes The size of the data in bytes
+   * @param seed The hash to continue from, to hash data in several parts */
+  static uint64_t HashContent(const void* pData, size_t nBytes, uint64_t seed = 0xcbf29ce484222325ull)
+  {
+    const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+    uint64_t hash = seed;
+
+    for (size_t i = 0; i < nBytes; i++)
+      hash = (hash ^ pBytes[i]) * 0x100000001b3ull;
+
+    return hash;
+  }
+
+  /** Get a shared asset, creating it if no live asset has the same key. Creation of different assets can run on several threads at once
+   * @tparam T The type of the asset, which is part of the key
+   * @param contentHash A hash of what the asset is made from, e.g. from HashContent()
+   * @param sampleRate The sample rate the asset is prepared for, or 0. if it does not depend on one
+   * @param createFunc A callable that returns a std::unique_ptr<T> holding the new asset, or nullptr on failure
+   * @return The asset, or nullptr if it could not be created */
+  template <typename T, typename F>
+  static std::shared_ptr<const T> Get(uint64_t contentHash, double sampleRate, F createFunc)
+  {
+    const Key key {std::type_index(typeid(T)), contentHash, sampleRate};
+
+    while (true)
+    {
+      std::shared_ptr<Entry> entry = FindOrAddEntry(key);
+      std::lock_guard<std::mutex> entryLock(entry->mutex);
+
+      // The last user of a previous asset removed this entry while we were waiting for it, so start again with a new one
+      if (entry->removed)
+      {
+        EraseEntry(key, entry);
+        continue;
+      }
+
+      std::shared_ptr<const T> asset = std::static_pointer_cast<const T>(entry->asset.lock());
+
+      if (!asset)
+      {
+        std::unique_ptr<T> newAsset = createFunc();
+
+        if (!newAsset)
+        {
+          entry->removed = true;
+          EraseEntry(key, entry);
+          return nullptr;
+        }
+
+        std::weak_ptr<Entry> weakEntry = entry;
+        asset = std::shared_ptr<const T>(newAsset.release(), [key, weakEntry](const T* pAsset) {
+          delete pAsset;
+          RemoveEntry(key, weakEntry);
+        });
+
+        entry->asset = asset;
+      }
+
+      return asset;
+    }
+  }
+
+  /** @return The number of assets in the registry, which are alive or being created */
+  static int NAssets()
+  {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    return static_cast<int>(registry.entries.size());
+  }
+
+private:
+  struct Key
+  {
+    std::type_index type;
+    uint64_t contentHash;
+    double sampleRate;
+
+    bool operator==(const Key& other) const
+    {
+      return type == other.type && contentHash == other.contentHash && sampleRate == other.sampleRate;
+    }
+  };
+
+  struct KeyHash
+  {
+    size_t operator()(const Key& key) const
+    {
+      return key.type.hash_code() ^ std::hash<uint64_t>()(key.contentHash) ^ (std::hash<double>()(key.sampleRate) << 1);
+    }
+  };
+
+  /** One asset. Its mutex is held while the asset is created, so that only one thread creates it, without blocking lookups of other assets */
+  struct Entry
+  {
+    std::mutex mutex;
+    std::weak_ptr<const void> asset;
+    bool removed = false;
+  };
+
+  struct Registry
+  {
+    std::mutex mutex;
+    std::unordered_map<Key, std::shared_ptr<Entry>, KeyHash> entries;
+  };
+
+  static Registry& GetRegistry()
+  {
+    static Registry registry;
+    return registry;
+  }
+
+  static std::shared_ptr<Entry> FindOrAddEntry(const Key& key)
+  {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    std::shared_ptr<Entry>& entry = registry.entries[key];
+
+    if (!entry)
+      entry = std::make_shared<Entry>();
+
+    return entry;
+  }
+
+  /** Called when an asset is freed. The entry is kept if another thread has already created a new asset for the key.
+   * The registry mutex is never held while waiting for an entry's mutex, so assets can be created from within another asset's createFunc */
+  static void RemoveEntry(const Key& key, const std::weak_ptr<Entry>& weakEntry)
+  {
+    std::shared_ptr<Entry> entry = weakEntry.lock();
+
+    if (!entry)
+      return;
+
+    {
+      std::lock_guard<std::mutex> entryLock(entry->mutex);
+
+      if (!entry->asset.expired())
+        return;
+
+      entry->removed = true;
+    }
+
+    EraseEntry(key, entry);
+  }
+
+  static void EraseEntry(const Key& key, const std::shared_ptr<Entry>& entry)
+  {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    auto it = registry.entries.find(key);
+
+    if (it != registry.entries.end() && it->second == entry)
+      registry.entries.erase(it);
+  }
+};
+
+END_IPLUG_NAMESPACE
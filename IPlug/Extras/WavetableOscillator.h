@@ -0,0 +1,307 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+#pragma once
+
+/**
+ * @file
+ * Band-limited, mipmapped wavetable oscillator
+ * NOTE: WDL/fft.c must be compiled into the project, as for ISpectrumSender
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "IPlugPlatform.h"
+#include "IPlugUtilities.h"
+#include "Oscillator.h"
+#include "fft.h"
+
+BEGIN_IPLUG_NAMESPACE
+
+/** A set of single cycle frames, band-limited by FFT into one mip level per octave.
+ * Once built a table is read-only, and it is shared via std::shared_ptr<const Wavetable>, so any number of voices and plug-in instances can read the same memory */
+class Wavetable
+{
+public:
+  /** Samples per frame at every mip level */
+  static constexpr int kTableSize = 2048;
+
+  /** Level 0 keeps kTableSize / 2 - 1 harmonics, and each subsequent level keeps half as many, down to a sine, which the top levels always keep */
+  static constexpr int kNumLevels = 11;
+
+  enum EShape
+  {
+    kSine = 0,
+    kTriangle,
+    kSaw,
+    kSquare,
+    kNumShapes
+  };
+
+  /** Build a wavetable from single cycle frames. Prefer Create() or Get(), which share tables
+   * @param pFrames nFrames * frameSize samples, one frame after another
+   * @param nFrames The number of frames
+   * @param frameSize The number of samples in each frame, which must be a power of two. Harmonics above kTableSize / 2 are discarded */
+  Wavetable(const float* pFrames, int nFrames, int frameSize)
+  {
+    assert(nFrames > 0);
+    assert(frameSize >= 4 && !(frameSize & (frameSize - 1)) && "frameSize must be a power of two");
+
+    WDL_fft_init();
+
+    std::vector<WDL_FFT_COMPLEX> buffer(frameSize);
+    const int nHarmonics = std::min(frameSize, kTableSize) / 2;
+    Spectra spectra(nFrames, Spectrum(nHarmonics));
+
+    for (auto f = 0; f < nFrames; f++)
+    {
+      const float* pFrame = pFrames + f * frameSize;
+
+      for (auto i = 0; i < frameSize; i++)
+      {
+        buffer[i].re = pFrame[i] / frameSize;
+        buffer[i].im = 0.f;
+      }
+
+      WDL_fft(buffer.data(), frameSize, false);
+
+      // The DC offset is discarded, as is the nyquist bin, whose phase is ambiguous
+      for (auto h = 1; h < nHarmonics; h++)
+      {
+        const WDL_FFT_COMPLEX& bin = buffer[WDL_fft_permute(frameSize, h)];
+        spectra[f][h] = {bin.re, bin.im};
+      }
+    }
+
+    BuildLevels(spectra);
+  }
+
+  /** Get a shared table built from single cycle frames. If a table with the same key is still alive it is returned, and the frames are not analysed again
+   * @param key A unique name for the table, e.g. its resource name
+   * @see Wavetable() for the other arguments */
+  static std::shared_ptr<const Wavetable> Create(const char* key, const float* pFrames, int nFrames, int frameSize)
+  {
+    return GetShared(key, [&]() { return std::make_shared<const Wavetable>(pFrames, nFrames, frameSize); });
+  }
+
+  /** Get a shared table containing a single band-limited classic waveform
+   * @param shape The waveform */
+  static std::shared_ptr<const Wavetable> Get(EShape shape)
+  {
+    static const char* keys[kNumShapes] = { "iplug::sine", "iplug::triangle", "iplug::saw", "iplug::square" };
+
+    return GetShared(keys[shape], [shape]() {
+      Spectra spectra(1, Spectrum(kTableSize / 2));
+
+      // Sine series coefficients b_h, where x(t) = sum(b_h * sin(2 pi h t)), stored as complex amplitudes -i * b_h / 2
+      for (auto h = 1; h < kTableSize / 2; h++)
+      {
+        double b = 0.;
+
+        switch (shape)
+        {
+          case kSine: b = h == 1 ? 1. : 0.; break;
+          case kTriangle: b = (h & 1) ? 8. / (PI * PI * h * h) * ((h & 2) ? -1. : 1.) : 0.; break;
+          case kSaw: b = 2. / (PI * h) * ((h & 1) ? 1. : -1.); break;
+          case kSquare: b = (h & 1) ? 4. / (PI * h) : 0.; break;
+          default: break;
+        }
+
+        spectra[0][h] = {0., -0.5 * b};
+      }
+
+      return std::shared_ptr<const Wavetable>(new Wavetable(spectra));
+    });
+  }
+
+  /** @return The number of frames */
+  int NFrames() const { return mNFrames; }
+
+  /** @return kTableSize + 1 samples for a frame at a mip level, the last sample repeating the first for interpolation */
+  const float* GetFrame(int level, int frame) const
+  {
+    return mData.data() + (level * mNFrames + frame) * (kTableSize + 1);
+  }
+
+private:
+  using Spectrum = std::vector<std::complex<double>>;
+  using Spectra = std::vector<Spectrum>;
+
+  explicit Wavetable(const Spectra& spectra)
+  {
+    BuildLevels(spectra);
+  }
+
+  /** Inverse FFT each frame's harmonics into every mip level */
+  void BuildLevels(const Spectra& spectra)
+  {
+    WDL_fft_init();
+
+    mNFrames = static_cast<int>(spectra.size());
+    mData.resize(kNumLevels * mNFrames * (kTableSize + 1));
+
+    std::vector<WDL_FFT_COMPLEX> buffer(kTableSize);
+
+    for (auto level = 0; level < kNumLevels; level++)
+    {
+      // The fundamental is kept at every level, so the highest frequencies play a sine rather than silence
+      const int maxHarmonic = std::max(2, (kTableSize / 2) >> level);
+
+      for (auto f = 0; f < mNFrames; f++)
+      {
+        const Spectrum& spectrum = spectra[f];
+        const int nHarmonics = std::min(maxHarmonic, static_cast<int>(spectrum.size()));
+
+        std::fill(buffer.begin(), buffer.end(), WDL_FFT_COMPLEX{0.f, 0.f});
+
+        for (auto h = 1; h < nHarmonics; h++)
+        {
+          WDL_FFT_COMPLEX& bin = buffer[WDL_fft_permute(kTableSize, h)];
+          WDL_FFT_COMPLEX& mirror = buffer[WDL_fft_permute(kTableSize, kTableSize - h)];
+          bin.re = static_cast<WDL_FFT_REAL>(spectrum[h].real());
+          bin.im = static_cast<WDL_FFT_REAL>(spectrum[h].imag());
+          mirror.re = bin.re;
+          mirror.im = -bin.im;
+        }
+
+        WDL_fft(buffer.data(), kTableSize, true);
+
+        float* pFrame = mData.data() + (level * mNFrames + f) * (kTableSize + 1);
+
+        for (auto i = 0; i < kTableSize; i++)
+          pFrame[i] = buffer[i].re;
+
+        pFrame[kTableSize] = pFrame[0];
+      }
+    }
+  }
+
+  /** Return the live table for a key, or build and register one. Only weak references are held, so a table is freed when the last oscillator using it goes away */
+  template <typename F>
+  static std::shared_ptr<const Wavetable> GetShared(const char* key, F createFunc)
+  {
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::weak_ptr<const Wavetable>> tables;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::weak_ptr<const Wavetable>& entry = tables[key];
+    std::shared_ptr<const Wavetable> table = entry.lock();
+
+    if (!table)
+    {
+      table = createFunc();
+      entry = table;
+    }
+
+    return table;
+  }
+
+  int mNFrames = 0;
+  std::vector<float> mData;
+};
+
+/** A wavetable oscillator, which crossfades between adjacent mip levels to stay free of aliasing, and between adjacent frames according to a scan position.
+ * The table is shared and never written, so it can be used by many voices at once */
+template <typename T>
+class WavetableOscillator : public IOscillator<T>
+{
+public:
+  WavetableOscillator(std::shared_ptr<const Wavetable> table = Wavetable::Get(Wavetable::kSaw), double startPhase = 0., double startFreq = 1.)
+  : IOscillator<T>(startPhase, startFreq)
+  , mTable(table)
+  {
+  }
+
+  /** Set the table to play. NOTE: if this releases the last reference to the previous table, it will be freed on the calling thread */
+  void SetWavetable(std::shared_ptr<const Wavetable> table) { mTable = table; }
+
+  /** Set the scan position through the frames of the table. The position is ramped over the next block
+   * @param position 0. for the first frame, 1. for the last */
+  void SetPosition(double position) { mTargetPosition = Clip(position, 0., 1.); }
+
+  inline T Process(double freqHz) override
+  {
+    IOscillator<T>::SetFreqCPS(freqHz);
+
+    T output = 0.;
+    ProcessBlock(&output, 1);
+
+    return output;
+  }
+
+  /** Fill a block at the current frequency. The mip levels are chosen once per block, the phase and frame position are computed per sample without branches, so the loop can be vectorized */
+  void ProcessBlock(T* pOutput, int nFrames)
+  {
+    const Wavetable& table = *mTable;
+    const double phaseIncr = IOscillator<T>::mPhaseIncr;
+    const double phase = IOscillator<T>::mPhase;
+
+    // Level n keeps harmonics below kTableSize / 2^(n+1), so choosing log2(|incr| * kTableSize) + 1 keeps every harmonic of both levels below nyquist
+    const double levelPos = Clip(std::log2(std::max(std::abs(phaseIncr) * Wavetable::kTableSize, 1e-9)) + 1., 0., Wavetable::kNumLevels - 1.);
+    const int levelA = static_cast<int>(levelPos);
+    const int levelB = std::min(levelA + 1, Wavetable::kNumLevels - 1);
+    const T levelFrac = static_cast<T>(levelPos - levelA);
+
+    const int lastFrame = table.NFrames() - 1;
+    const int frameStride = Wavetable::kTableSize + 1;
+    const float* pLevelA = table.GetFrame(levelA, 0);
+    const float* pLevelB = table.GetFrame(levelB, 0);
+    const double positionIncr = (mTargetPosition - mPosition) / nFrames;
+
+    for (auto s = 0; s < nFrames; s++)
+    {
+      double p = phase + s * phaseIncr;
+      p -= std::floor(p);
+
+      const double idx = p * Wavetable::kTableSize;
+      const int i = static_cast<int>(idx);
+      const T frac = static_cast<T>(idx - i);
+
+      const double framePos = (mPosition + (s + 1) * positionIncr) * lastFrame;
+      const int f0 = std::min(static_cast<int>(framePos), std::max(lastFrame - 1, 0));
+      const int f1 = std::min(f0 + 1, lastFrame);
+      const T frameFrac = static_cast<T>(framePos - f0);
+
+      const float* pA0 = pLevelA + f0 * frameStride + i;
+      const float* pA1 = pLevelA + f1 * frameStride + i;
+      const float* pB0 = pLevelB + f0 * frameStride + i;
+      const float* pB1 = pLevelB + f1 * frameStride + i;
+
+      const T a0 = pA0[0] + frac * (pA0[1] - pA0[0]);
+      const T a1 = pA1[0] + frac * (pA1[1] - pA1[0]);
+      const T b0 = pB0[0] + frac * (pB0[1] - pB0[0]);
+      const T b1 = pB1[0] + frac * (pB1[1] - pB1[0]);
+      const T a = a0 + frameFrac * (a1 - a0);
+      const T b = b0 + frameFrac * (b1 - b0);
+
+      pOutput[s] = a + levelFrac * (b - a);
+    }
+
+    const double endPhase = phase + nFrames * phaseIncr;
+    IOscillator<T>::mPhase = endPhase - std::floor(endPhase);
+    mPosition = mTargetPosition;
+  }
+
+private:
+  std::shared_ptr<const Wavetable> mTable;
+  double mPosition = 0.;
+  double mTargetPosition = 0.;
+};
+
+END_IPLUG_NAMESPACE
@@ -13,6 +13,7 @@
  * @brief IPlugAPIBase implementation
  */
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <ctime>
@@ -120,6 +121,191 @@ void IPlugAPIBase::SetParameterValue(int idx, double normalizedValue)
   GetParam(idx)->SetNormalized(normalizedValue);
   InformHostOfParamChange(idx, normalizedValue);
   OnParamChange(idx, kUI);
+  
+  if (!mParamDependencies.empty())
+    PropagateParamChanges(&idx, 1);
+}
+
+void IPlugAPIBase::AddParamDependency(int targetIdx, const std::initializer_list<int>& sourceIdxs, ParamDependencyFunc func)
+{
+  assert(std::none_of(mParamDependencies.begin(), mParamDependencies.end(), [targetIdx](const ParamDependency& d) { return d.targetIdx == targetIdx; }) && "A parameter can only have one dependency");
+  
+  mParamDependencies.push_back({targetIdx, sourceIdxs, func});
+  mDependencyState = kDependenciesUnsorted;
+}
+
+bool IPlugAPIBase::InitParamDependencies()
+{
+  const int nDependencies = static_cast<int>(mParamDependencies.size());
+  std::vector<int> dependencyOfParam(NParams(), -1);
+  
+  for (auto d = 0; d < nDependencies; d++)
+    dependencyOfParam[mParamDependencies[d].targetIdx] = d;
+  
+  // Sort topologically (Kahn's algorithm): a dependency is ready once the dependencies computing its sources have been placed
+  std::vector<std::vector<int>> dependents(nDependencies);
+  std::vector<int> nWaitingFor(nDependencies, 0);
+  
+  for (auto d = 0; d < nDependencies; d++)
+  {
+    for (auto sourceIdx : mParamDependencies[d].sourceIdxs)
+    {
+      const int sourceDependency = dependencyOfParam[sourceIdx];
+      
+      if (sourceDependency >= 0)
+      {
+        dependents[sourceDependency].push_back(d);
+        nWaitingFor[d]++;
+      }
+    }
+  }
+  
+  std::vector<int> order;
+  order.reserve(nDependencies);
+  
+  for (auto d = 0; d < nDependencies; d++)
+  {
+    if (nWaitingFor[d] == 0)
+      order.push_back(d);
+  }
+  
+  for (size_t i = 0; i < order.size(); i++)
+  {
+    for (auto d : dependents[order[i]])
+    {
+      if (--nWaitingFor[d] == 0)
+        order.push_back(d);
+    }
+  }
+  
+  if (static_cast<int>(order.size()) < nDependencies)
+  {
+    for (auto d = 0; d < nDependencies; d++)
+    {
+      if (nWaitingFor[d] > 0)
+        DBGMSG("Parameter dependency cycle includes %s\n", GetParam(mParamDependencies[d].targetIdx)->GetName());
+    }
+    
+    assert(false && "Parameter dependencies form a cycle");
+    mDependencyState = kDependenciesCyclic;
+    return false;
+  }
+  
+  std::vector<ParamDependency> sorted;
+  sorted.reserve(nDependencies);
+  
+  for (auto d : order)
+    sorted.push_back(std::move(mParamDependencies[d]));
+  
+  mParamDependencies = std::move(sorted);
+  mParamDependents.assign(NParams(), {});
+  
+  for (auto d = 0; d < nDependencies; d++)
+  {
+    for (auto sourceIdx : mParamDependencies[d].sourceIdxs)
+    {
+      std::vector<int>& readers = mParamDependents[sourceIdx];
+      
+      if (readers.empty() || readers.back() != d)
+        readers.push_back(d);
+    }
+  }
+  
+  mParamChangedMarks.assign(NParams(), 0);
+  mDependencyReachedMarks.assign(nDependencies, 0);
+  mPropagationNumber = 0;
+  mReachedDependencies.reserve(nDependencies);
+  mChangedDependents.reserve(nDependencies);
+  mDependencyState = kDependenciesSorted;
+  
+  return true;
+}
+
+void IPlugAPIBase::PropagateParamChanges(const int* pParamIdxs, int nParams)
+{
+  if (mPropagatingParamChanges || mParamDependencies.empty())
+    return;
+  
+  if (mDependencyState == kDependenciesUnsorted)
+    InitParamDependencies();
+  
+  if (mDependencyState != kDependenciesSorted)
+    return;
+  
+  mPropagatingParamChanges = true;
+  
+  if (++mPropagationNumber == 0)
+  {
+    std::fill(mParamChangedMarks.begin(), mParamChangedMarks.end(), 0);
+    std::fill(mDependencyReachedMarks.begin(), mDependencyReachedMarks.end(), 0);
+    mPropagationNumber = 1;
+  }
+  
+  const uint32_t mark = mPropagationNumber;
+  
+  // Find every dependency downstream of the changed parameters, each once, then evaluate them in dependency order.
+  // mChangedDependents is used as the stack of parameters to visit, before it collects the results
+  mReachedDependencies.clear();
+  mChangedDependents.clear();
+  
+  for (auto i = 0; i < nParams; i++)
+  {
+    mParamChangedMarks[pParamIdxs[i]] = mark;
+    mChangedDependents.push_back(pParamIdxs[i]);
+  }
+  
+  while (!mChangedDependents.empty())
+  {
+    const int paramIdx = mChangedDependents.back();
+    mChangedDependents.pop_back();
+    
+    for (auto d : mParamDependents[paramIdx])
+    {
+      if (mDependencyReachedMarks[d] != mark)
+      {
+        mDependencyReachedMarks[d] = mark;
+        mReachedDependencies.push_back(d);
+        mChangedDependents.push_back(mParamDependencies[d].targetIdx);
+      }
+    }
+  }
+  
+  std::sort(mReachedDependencies.begin(), mReachedDependencies.end());
+  
+  // A dependency is only evaluated if one of its sources actually changed, so propagation stops where values settle
+  for (auto d : mReachedDependencies)
+  {
+    const ParamDependency& dependency = mParamDependencies[d];
+    
+    if (std::none_of(dependency.sourceIdxs.begin(), dependency.sourceIdxs.end(), [&](int sourceIdx) { return mParamChangedMarks[sourceIdx] == mark; }))
+      continue;
+    
+    IParam* pParam = GetParam(dependency.targetIdx);
+    const double prevValue = pParam->Value();
+    pParam->Set(dependency.func());
+    
+    if (pParam->Value() != prevValue)
+    {
+      mParamChangedMarks[dependency.targetIdx] = mark;
+      mChangedDependents.push_back(dependency.targetIdx);
+    }
+  }
+  
+  // Notify after every value has settled, once per changed parameter, so that the host, DSP and UI never see intermediate values
+  for (auto paramIdx : mChangedDependents)
+  {
+    BeginInformHostOfParamChange(paramIdx);
+    InformHostOfParamChange(paramIdx, GetParam(paramIdx)->GetNormalized());
+    EndInformHostOfParamChange(paramIdx);
+  }
+  
+  for (auto paramIdx : mChangedDependents)
+    OnParamChange(paramIdx, kUI);
+  
+  for (auto paramIdx : mChangedDependents)
+    SendParameterValueFromDelegate(paramIdx, GetParam(paramIdx)->GetNormalized(), true);
+  
+  mPropagatingParamChanges = false;
 }
 
 void IPlugAPIBase::DirtyParametersFromUI()
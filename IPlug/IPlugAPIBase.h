@@ -12,7 +12,9 @@
 
 #include <cstring>
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <vector>
 
 #include "ptrlist.h"
 #include "mutex.h"
@@ -117,6 +119,26 @@ public:
    * @param normalizedValue The new (normalised) value */
   void SetParameterValue(int paramIdx, double normalizedValue);
   
+  /** A function that computes a dependent parameter's value, not normalized, from the current values of the parameters it depends on */
+  using ParamDependencyFunc = std::function<double()>;
+  
+  /** Declare that a parameter's value is derived from other parameters, e.g. for macro controls. When a parameter changes via SetParameterValue(), every parameter that depends on it,
+   * directly or through other dependent parameters, is recomputed once, in dependency order. The host and UI are then informed once of each parameter whose value changed.
+   * Call this in your plug-in's constructor, followed by InitParamDependencies()
+   * @param targetIdx The dependent parameter. A parameter can only have one dependency
+   * @param sourceIdxs The parameters that the target is computed from
+   * @param func Computes the target's value */
+  void AddParamDependency(int targetIdx, const std::initializer_list<int>& sourceIdxs, ParamDependencyFunc func);
+  
+  /** Sort the dependencies added with AddParamDependency() into the order in which they are evaluated. This happens when a change is first propagated, but call it at the end of your constructor so that a cycle is found at init
+   * @return \c false if the dependencies form a cycle, in which case changes are not propagated */
+  bool InitParamDependencies();
+  
+  /** Propagate changes to parameters that were set by other means than SetParameterValue(), e.g. several at once. Call this on the main thread
+   * @param pParamIdxs The parameters that changed
+   * @param nParams The number of parameters */
+  void PropagateParamChanges(const int* pParamIdxs, int nParams);
+  
   /** Get the color of the track that the plug-in is inserted on */
   virtual void GetTrackColor(int& r, int& g, int& b) { r = 0; g = 0; b = 0; }
 
@@ -227,9 +249,39 @@ private:
   friend class IPlugWasmDSP;
 
 private:
+  /** A dependent parameter, and how it is computed */
+  struct ParamDependency
+  {
+    int targetIdx;
+    std::vector<int> sourceIdxs;
+    ParamDependencyFunc func;
+  };
+  
+  enum EDependencyState
+  {
+    kDependenciesUnsorted,
+    kDependenciesSorted,
+    kDependenciesCyclic
+  };
+  
   WDL_String mParamDisplayStr;
   std::unique_ptr<Timer> mTimer;
   
+  /** The dependencies, in evaluation order once sorted, so a dependency comes after those that compute its sources */
+  std::vector<ParamDependency> mParamDependencies;
+  /** For each parameter, the indexes in mParamDependencies of the dependencies that read it */
+  std::vector<std::vector<int>> mParamDependents;
+  EDependencyState mDependencyState = kDependenciesUnsorted;
+  /** Marks for parameters that changed, and dependencies that were reached, in a propagation. They hold the propagation's number, so they never need clearing */
+  std::vector<uint32_t> mParamChangedMarks;
+  std::vector<uint32_t> mDependencyReachedMarks;
+  uint32_t mPropagationNumber = 0;
+  /** Scratch lists reused by every propagation */
+  std::vector<int> mReachedDependencies;
+  std::vector<int> mChangedDependents;
+  /** Guards against propagating again from OnParamChange() when a propagation notifies it */
+  bool mPropagatingParamChanges = false;
+  
   IPlugQueue<ParamTuple> mParamChangeFromProcessor {PARAM_TRANSFER_SIZE};
   IPlugQueue<IMidiMsg> mMidiMsgsFromEditor {MIDI_TRANSFER_SIZE}; // a queue of midi messages generated in the editor by clicking keyboard UI etc
   IPlugQueue<IMidiMsg> mMidiMsgsFromProcessor {MIDI_TRANSFER_SIZE}; // a queue of MIDI messages received (potentially on the high priority thread), by the processor to send to the editor
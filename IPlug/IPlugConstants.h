@@ -122,6 +122,8 @@ static const int MAX_PARAM_DISPLAY_PRECISION = 6;
 // All version ints are stored as 0xVVVVRRMM: V = version, R = revision, M = minor revision.
 #define IPLUG_VERSION 0x010000
 #define IPLUG_VERSION_MAGIC 'pfft'
+#define IPLUG_PARAM_STATE_MAGIC 'pstc' // marks parameter state written in the compact, ID keyed format
+#define IPLUG_PARAM_STATE_VERSION 1
 
 static const int DEFAULT_BLOCK_SIZE = 1024;
 static const double DEFAULT_TEMPO = 120.0;
@@ -146,6 +148,17 @@ static const int kNoTag = -1;
 //static const uint64_t kInvalidBusType = 0;
 //#endif
 
+/** @enum EParamStateFlags
+ * Flags for the parameter state format written by IPluginBase::SerializeParams(), see IPluginBase::SetParamStateFlags()
+ */
+enum EParamStateFlags
+{
+  kParamStateLegacy = 0,            // Every parameter value in index order, as raw doubles
+  kParamStateCompact = 1 << 0,      // Versioned, with values keyed by IParam::GetStableID(), so parameters may be added or reordered
+  kParamStateOmitDefaults = 1 << 1, // Leave out parameters at their default value (compact format only)
+  kParamStateCompress = 1 << 2      // Compress the values with zlib (compact format only, requires IPLUG_STATE_COMPRESSION)
+};
+
 /** @enum EParamSource
  * Used to identify the source of a parameter change
  */
@@ -17,7 +17,9 @@
 
 #include <cassert>
 #include <cstring>
+#include <numeric>
 #include <stdint.h>
+#include <vector>
 
 #include "ptrlist.h"
 
@@ -135,6 +137,20 @@ public:
     }
   }
   
+  /** Called once when many parameter values have been applied together, e.g. by IPluginBase::ApplyParamValues() on preset recall, with only the parameters whose values changed.
+   * Override this to update DSP in bulk. Like OnParamReset(), this must update both DSP and UI. The default implementation calls OnParamChange() and OnParamChangeUI() for each changed parameter.
+   * @param pParamIdxs The indexes of the parameters that changed, in ascending order
+   * @param nParams The number of parameters that changed
+   * @param source Specifies the source of the parameter changes */
+  virtual void OnParamsChanged(const int* pParamIdxs, int nParams, EParamSource source)
+  {
+    for (int i = 0; i < nParams; ++i)
+    {
+      OnParamChange(pParamIdxs[i], source);
+      OnParamChangeUI(pParamIdxs[i], source);
+    }
+  }
+  
   /** Handle incoming MIDI messages sent to the user interface
    * @param msg The MIDI message to process  */
   virtual void OnMidiMsgUI(const IMidiMsg& msg) {};
@@ -162,14 +178,13 @@ public:
   virtual bool OnKeyUp(const IKeyPress& key) { return false; }
   
 #pragma mark - Methods for sending values TO the user interface
-  /** Loops through all parameters, calling SendParameterValueFromDelegate() with the current value of the parameter
+  /** Sends the current values of all parameters with SendParameterValuesFromDelegate()
    *  This is important when modifying groups of parameters, restoring state and opening the UI, in order to update it with the latest values*/
   void SendCurrentParamValuesFromDelegate()
   {
-    for (int i = 0; i < NParams(); ++i)
-    {
-      SendParameterValueFromDelegate(i, GetParam(i)->GetNormalized(), true);
-    }
+    std::vector<int> paramIdxs(NParams());
+    std::iota(paramIdxs.begin(), paramIdxs.end(), 0);
+    SendParameterValuesFromDelegate(paramIdxs.data(), NParams());
   }
   
   /** SendControlValueFromDelegate (Abbreviation: SCVFD)
@@ -224,6 +239,18 @@ public:
    * @param value The new value of the parameter
    * @param normalized \c true if value is normalised */
   virtual void SendParameterValueFromDelegate(int paramIdx, double value, bool normalized) { OnParamChangeUI(paramIdx, EParamSource::kDelegate); } // TODO: normalised?
+  
+  /** Update the user interface with the current values of several parameters at once, e.g. after a preset is recalled.
+   * The default implementation calls SendParameterValueFromDelegate() for each. Override it if the UI can be updated more efficiently in one go, as IGEditorDelegate does
+   * @param pParamIdxs The indexes of the parameters
+   * @param nParams The number of parameters */
+  virtual void SendParameterValuesFromDelegate(const int* pParamIdxs, int nParams)
+  {
+    for (int i = 0; i < nParams; ++i)
+    {
+      SendParameterValueFromDelegate(pParamIdxs[i], GetParam(pParamIdxs[i])->GetNormalized(), true);
+    }
+  }
 
 #pragma mark - Methods for sending values FROM the user interface
   // The following methods are called from the user interface in order to set or query values of parameters in the class implementing IEditorDelegate
@@ -15,6 +15,7 @@
 
 #include <cstdio>
 #include <algorithm>
+#include <typeinfo>
 
 #include "IPlugParameter.h"
 #include "IPlugLogger.h"
@@ -79,6 +80,87 @@ double IParam::ShapeExp::ValueToNormalized(double value, const IParam& param) co
   return (std::log(value) - mAdd) / mMul;
 }
 
+#pragma mark - Approximations
+
+// Branch free approximations of exp2() and log2() for the batch conversions, written so that the loops which call them can be vectorized.
+// Out of range values are handled with integer masks, as GCC will not vectorize a loop in which a floating point comparison feeds further arithmetic
+// unless trapping math is disabled, and the masks are made with shifts rather than comparisons, as SSE2 has no 64 bit comparison.
+// The batch conversions clip their inputs in separate passes for the same reason
+namespace
+{
+  const double kLn2 = 0.6931471805599453;
+  const double kLog2e = 1.4426950408889634;
+  
+  /** 2^x for x below 1024. The argument is split into an integer, which is placed in the exponent, and a fraction in -0.5 to 0.5, for which a degree 7 Taylor series has a relative error below 6e-9.
+   * Results below the normal range of double are 0 */
+  inline double FastExp2(double x)
+  {
+    // Adding 1.5 * 2^52 rounds to an integer k, and leaves the bits of the sum as those of 1.5 * 2^52 plus k
+    const double shifter = 6755399441055744.0;
+    const double shifted = x + shifter;
+    const double rounded = shifted - shifter;
+    int64_t k;
+    memcpy(&k, &shifted, sizeof(k));
+    k -= 0x4338000000000000LL;
+    
+    const double f = (x - rounded) * kLn2;
+    const double p = 1. + f * (1. + f * (1. / 2. + f * (1. / 6. + f * (1. / 24. + f * (1. / 120. + f * (1. / 720. + f * (1. / 5040.)))))));
+    
+    int64_t pBits;
+    memcpy(&pBits, &p, sizeof(pBits));
+    pBits += k * (1LL << 52);
+    pBits &= -static_cast<int64_t>(static_cast<uint64_t>(-1022 - k) >> 63);
+    
+    double result;
+    memcpy(&result, &pBits, sizeof(result));
+    return result;
+  }
+  
+  /** log2(x) for x >= 0. The mantissa is scaled to sqrt(0.5) to sqrt(2), where the series 2 atanh((m - 1) / (m + 1)) up to the 9th power has an absolute error below 1e-9.
+   * log2(0) is returned as -1023, rather than -infinity */
+  inline double FastLog2(double x)
+  {
+    int64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    
+    // Mantissas above sqrt(2) are halved and the exponent incremented
+    const int64_t mantissaBits = bits & 0x000fffffffffffffLL;
+    const int64_t high = static_cast<uint64_t>(0x6a09e667f3bcdLL - mantissaBits) >> 63;
+    
+    // The biased exponent is converted to double by placing it in the mantissa of 2^52, which avoids an integer conversion that would not vectorize
+    const int64_t exponentBits = (((bits >> 52) & 0x7ff) + high) | 0x4330000000000000LL;
+    double exponent;
+    memcpy(&exponent, &exponentBits, sizeof(exponent));
+    exponent -= 4503599627370496.0 + 1023.;
+    
+    bits = mantissaBits | (0x3ff0000000000000LL - (high << 52));
+    double m;
+    memcpy(&m, &bits, sizeof(m));
+    
+    const double t = (m - 1.) / (m + 1.);
+    const double t2 = t * t;
+    const double ln = 2. * t * (1. + t2 * (1. / 3. + t2 * (1. / 5. + t2 * (1. / 7. + t2 * (1. / 9.)))));
+    
+    return exponent + ln * kLog2e;
+  }
+  
+  /** x^y for x in 0 to 1 and y > 0, where 0^y is 0 */
+  inline double PowOrZero(double x, double y)
+  {
+    const double power = FastExp2(y * FastLog2(x));
+    
+    int64_t xBits, powerBits;
+    memcpy(&xBits, &x, sizeof(xBits));
+    memcpy(&powerBits, &power, sizeof(powerBits));
+    // The sign bit is shifted out, so that -0 is also treated as 0
+    powerBits &= -static_cast<int64_t>((0 - (static_cast<uint64_t>(xBits) << 1)) >> 63);
+    
+    double result;
+    memcpy(&result, &powerBits, sizeof(result));
+    return result;
+  }
+}
+
 #pragma mark -
 
 IParam::IParam()
@@ -147,6 +229,7 @@ void IParam::InitDouble(const char* name, double defaultVal, double minVal, doub
   strcpy(mName, name);
   strcpy(mLabel, label);
   strcpy(mParamGroup, group);
+  mStableID = StableIDFromName(name);
   
   // N.B. apply stepping and constraints to the default value (and store the result)
   mMin = minVal;
@@ -168,6 +251,32 @@ void IParam::InitDouble(const char* name, double defaultVal, double minVal, doub
     
   mShape = std::unique_ptr<Shape>(shape.Clone());
   mShape->Init(*this);
+  
+  // Only exact types are devirtualized, as a subclass may override the conversions
+  const Shape& initShape = *mShape;
+  
+  if (typeid(initShape) == typeid(ShapeLinear))
+  {
+    mFastShapeID = kShapeLinear;
+  }
+  else if (typeid(initShape) == typeid(ShapePowCurve))
+  {
+    mFastShapeID = kShapePowCurve;
+    mShapeA = static_cast<const ShapePowCurve&>(initShape).mShape;
+    mShapeB = 1.0 / mShapeA;
+  }
+  else if (typeid(initShape) == typeid(ShapeExp))
+  {
+    mFastShapeID = kShapeExponential;
+    mShapeA = static_cast<const ShapeExp&>(initShape).mAdd;
+    mShapeB = static_cast<const ShapeExp&>(initShape).mMul;
+  }
+  else
+  {
+    mFastShapeID = kShapeUnknown;
+  }
+  
+  InvalidateDisplayCache();
 }
 
 void IParam::InitFrequency(const char *name, double defaultVal, double minVal, double maxVal, double step, int flags, const char *group)
@@ -243,6 +352,21 @@ void IParam::Init(const IParam& p, const char* searchStr, const char* replaceStr
     const char* str = p.GetDisplayTextAtIdx(i, &val);
     SetDisplayText(val, str);
   }
+
+  SetSmoothing(p.mSmoothing, p.mSmoothingTimeMs);
+}
+
+uint32_t IParam::StableIDFromName(const char* name)
+{
+  uint32_t hash = 2166136261u;
+  
+  for (const char* pChar = name; *pChar; pChar++)
+  {
+    hash ^= static_cast<uint8_t>(*pChar);
+    hash *= 16777619u;
+  }
+  
+  return hash;
 }
 
 void IParam::SetDisplayText(double value, const char* str)
@@ -252,11 +376,19 @@ void IParam::SetDisplayText(double value, const char* str)
   DisplayText* pDT = mDisplayTexts.Get() + n;
   pDT->mValue = value;
   strcpy(pDT->mText, str);
+  
+  if (n == 0)
+    mDisplayTextsConsecutive = value == std::floor(value);
+  else
+    mDisplayTextsConsecutive = mDisplayTextsConsecutive && value == mDisplayTexts.Get()[0].mValue + n;
+  
+  InvalidateDisplayCache();
 }
 
 void IParam::SetDisplayPrecision(int precision)
 {
   mDisplayPrecision = precision;
+  InvalidateDisplayCache();
 }
 
 void IParam::GetDisplay(double value, bool normalized, WDL_String& str, bool withDisplayText) const
@@ -269,6 +401,65 @@ void IParam::GetDisplay(double value, bool normalized, WDL_String& str, bool wit
     return;
   }
 
+  DisplayCache& cache = mDisplayCache[withDisplayText ? 1 : 0];
+  const uint32_t generation = mDisplayGeneration.load(std::memory_order_acquire);
+
+  if (cache.Read(value, generation, str))
+    return;
+
+  FormatDisplay(value, withDisplayText, str);
+  cache.Write(value, generation, str.Get());
+}
+
+bool IParam::DisplayCache::Read(double value, uint32_t generation, WDL_String& str) const
+{
+  const uint32_t seq = mSeq.load(std::memory_order_acquire);
+
+  if (seq & 1)
+    return false;
+
+  const uint32_t cachedGeneration = mGeneration.load(std::memory_order_relaxed);
+  const double cachedValue = mValue.load(std::memory_order_relaxed);
+  uint64_t words[kNWords];
+
+  for (auto i = 0; i < kNWords; i++)
+    words[i] = mText[i].load(std::memory_order_relaxed);
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  if (mSeq.load(std::memory_order_relaxed) != seq || cachedGeneration != generation || cachedValue != value)
+    return false;
+
+  char text[kNWords * 8];
+  memcpy(text, words, sizeof(text));
+  text[MAX_PARAM_DISPLAY_LEN - 1] = 0;
+  str.Set(text);
+  return true;
+}
+
+void IParam::DisplayCache::Write(double value, uint32_t generation, const char* text)
+{
+  uint32_t seq = mSeq.load(std::memory_order_relaxed);
+
+  if ((seq & 1) || !mSeq.compare_exchange_strong(seq, seq + 1, std::memory_order_relaxed))
+    return;
+
+  std::atomic_thread_fence(std::memory_order_release);
+
+  uint64_t words[kNWords] = {};
+  strncpy(reinterpret_cast<char*>(words), text, MAX_PARAM_DISPLAY_LEN - 1);
+
+  mGeneration.store(generation, std::memory_order_relaxed);
+  mValue.store(value, std::memory_order_relaxed);
+
+  for (auto i = 0; i < kNWords; i++)
+    mText[i].store(words[i], std::memory_order_relaxed);
+
+  mSeq.store(seq + 2, std::memory_order_release);
+}
+
+void IParam::FormatDisplay(double value, bool withDisplayText, WDL_String& str) const
+{
   if (withDisplayText)
   {
     const char* displayText = GetDisplayText(value);
@@ -294,9 +485,7 @@ void IParam::GetDisplay(double value, bool normalized, WDL_String& str, bool wit
   }
   else if ((mFlags & kFlagSignDisplay) && displayValue)
   {
-    char fmt[16];
-    snprintf(fmt, 16, "%%+.%df", mDisplayPrecision);
-    str.SetFormatted(MAX_PARAM_DISPLAY_LEN, fmt, displayValue);
+    str.SetFormatted(MAX_PARAM_DISPLAY_LEN, "%+.*f", mDisplayPrecision, displayValue);
   }
   else
   {
@@ -327,6 +516,17 @@ int IParam::NDisplayTexts() const
 const char* IParam::GetDisplayText(double value) const
 {
   int n = mDisplayTexts.GetSize();
+  
+  if (n && mDisplayTextsConsecutive)
+  {
+    const double offset = value - mDisplayTexts.Get()[0].mValue;
+    
+    if (offset >= 0. && offset < n && offset == std::floor(offset))
+      return mDisplayTexts.Get()[static_cast<int>(offset)].mText;
+    
+    return "";
+  }
+  
   for (DisplayText* pDT = mDisplayTexts.Get(); n; --n, ++pDT)
   {
     if (value == pDT->mValue) return pDT->mText;
@@ -420,6 +620,110 @@ void IParam::PrintDetails() const
   DBGMSG("%s %f", GetName(), Value());
 }
 
+void IParam::FromNormalized(const double* pNormalized, double* pValues, int n) const
+{
+  for (auto i = 0; i < n; i++)
+    pValues[i] = FromNormalized(pNormalized[i]);
+}
+
+void IParam::ToNormalized(const double* pValues, double* pNormalized, int n) const
+{
+  for (auto i = 0; i < n; i++)
+    pNormalized[i] = ToNormalized(pValues[i]);
+}
+
+void IParam::FromNormalizedApprox(const double* pNormalized, double* pValues, int n) const
+{
+  const double min = mMin;
+  const double range = mMax - mMin;
+  const double a = mShapeA;
+  const double b = mShapeB;
+  
+  if (mFastShapeID != kShapeLinear && mFastShapeID != kShapePowCurve && mFastShapeID != kShapeExponential)
+  {
+    FromNormalized(pNormalized, pValues, n);
+    return;
+  }
+  
+  // The inputs are clipped first, which keeps the approximations in range, then converted in place. Each shape has its own loop, so that the loops have no branches
+  for (auto i = 0; i < n; i++)
+    pValues[i] = Clip(pNormalized[i], 0., 1.);
+  
+  switch (mFastShapeID)
+  {
+    case kShapeLinear:
+      for (auto i = 0; i < n; i++)
+        pValues[i] = min + pValues[i] * range;
+      break;
+    case kShapePowCurve:
+      for (auto i = 0; i < n; i++)
+        pValues[i] = min + PowOrZero(pValues[i], a) * range;
+      break;
+    default:
+      for (auto i = 0; i < n; i++)
+        pValues[i] = FastExp2((a + pValues[i] * b) * kLog2e);
+      break;
+  }
+  
+  ConstrainBlock(pValues, pValues, n);
+}
+
+void IParam::ToNormalizedApprox(const double* pValues, double* pNormalized, int n) const
+{
+  const double min = mMin;
+  const double range = mMax - mMin;
+  const double a = mShapeA;
+  const double b = mShapeB;
+  
+  if (mFastShapeID != kShapeLinear && mFastShapeID != kShapePowCurve && mFastShapeID != kShapeExponential)
+  {
+    ToNormalized(pValues, pNormalized, n);
+    return;
+  }
+  
+  // The values are constrained first, then converted in place
+  ConstrainBlock(pValues, pNormalized, n);
+  
+  switch (mFastShapeID)
+  {
+    case kShapeLinear:
+      for (auto i = 0; i < n; i++)
+        pNormalized[i] = (pNormalized[i] - min) / range;
+      break;
+    case kShapePowCurve:
+      for (auto i = 0; i < n; i++)
+        pNormalized[i] = PowOrZero((pNormalized[i] - min) / range, b);
+      break;
+    default:
+      for (auto i = 0; i < n; i++)
+        pNormalized[i] = (FastLog2(pNormalized[i]) * kLn2 - a) / b;
+      break;
+  }
+  
+  for (auto i = 0; i < n; i++)
+    pNormalized[i] = Clip(pNormalized[i], 0., 1.);
+}
+
+void IParam::ConstrainBlock(const double* pValues, double* pConstrained, int n) const
+{
+  // The flags are tested once, outside the loops
+  const double min = mMin;
+  const double max = mMax;
+  
+  if (mFlags & kFlagStepped)
+  {
+    const double step = mStep;
+    
+    for (auto i = 0; i < n; i++)
+      pConstrained[i] = Clip(std::round(pValues[i] / step) * step, min, max);
+  }
+  else
+  {
+    for (auto i = 0; i < n; i++)
+      pConstrained[i] = Clip(pValues[i], min, max);
+  }
+}
+
 IParam::EShapeIDs IParam::GetShapeID() const
 {
   if (dynamic_cast<IParam::ShapeLinear*>(mShape.get()))
@@ -440,3 +744,106 @@ double IParam::GetShapeValue() const
     return 0.0;
 }
 
+
+void IParam::SetSmoothing(ESmoothing smoothing, double timeMs)
+{
+  mSmoothing = smoothing;
+  mSmoothingTimeMs = timeMs;
+  mSmoothingState.mSampleRate = 0.;
+  ResetSmoothing();
+  PrepareSmoothing(DEFAULT_BLOCK_SIZE);
+}
+
+void IParam::PrepareSmoothing(int maxBlockSize)
+{
+  if (mSmoothingState.mRamp.GetSize() < maxBlockSize)
+  {
+    mSmoothingState.mRamp.Resize(maxBlockSize);
+    mSmoothingState.mConstantFrames = 0;
+  }
+}
+
+void IParam::ProcessSmoothing(double sampleRate, int nFrames)
+{
+  SmoothingState& state = mSmoothingState;
+  const double target = Value();
+
+  // The first block after SetSmoothing() starts at the current value, rather than ramping from the default
+  if (state.mSampleRate == 0. || mSmoothing == kSmoothNone)
+  {
+    state.mValue = state.mTarget = target;
+    state.mSamplesRemaining = 0;
+  }
+
+  if (sampleRate != state.mSampleRate)
+  {
+    state.mCoeff = std::exp(-2. * PI / std::max(mSmoothingTimeMs * 0.001 * sampleRate, 1.));
+    state.mSampleRate = sampleRate;
+  }
+
+  // The ramp is sized by PrepareSmoothing() off the audio thread. A host that exceeds the block size it gave is a bug, but growing here stays memory safe
+  assert(nFrames <= state.mRamp.GetSize() && "Block is larger than the size passed to PrepareSmoothing()");
+
+  if (state.mRamp.GetSize() < nFrames)
+    PrepareSmoothing(nFrames);
+
+  if (target != state.mTarget)
+  {
+    state.mTarget = target;
+    state.mSamplesRemaining = std::max(static_cast<int>(mSmoothingTimeMs * 0.001 * sampleRate), 1);
+    state.mIncrement = (target - state.mValue) / state.mSamplesRemaining;
+  }
+
+  sample* pRamp = state.mRamp.Get();
+
+  if (state.mValue == target)
+  {
+    state.mConstant = true;
+
+    if (state.mConstantFrames < nFrames)
+    {
+      std::fill(pRamp, pRamp + nFrames, static_cast<sample>(target));
+      state.mConstantFrames = nFrames;
+    }
+
+    return;
+  }
+
+  state.mConstant = false;
+  state.mConstantFrames = 0;
+
+  if (mSmoothing == kSmoothLinear)
+  {
+    const int nRamp = std::min(nFrames, state.mSamplesRemaining);
+    const double start = state.mValue;
+    const double increment = state.mIncrement;
+
+    // Computed from the start of the block rather than accumulated, so the loop can be vectorized
+    for (auto s = 0; s < nRamp; s++)
+    {
+      pRamp[s] = static_cast<sample>(start + (s + 1) * increment);
+    }
+
+    std::fill(pRamp + nRamp, pRamp + nFrames, static_cast<sample>(target));
+
+    state.mSamplesRemaining -= nRamp;
+    state.mValue = state.mSamplesRemaining ? start + nRamp * increment : target;
+  }
+  else
+  {
+    const double coeff = state.mCoeff;
+    double delta = state.mValue - target;
+
+    for (auto s = 0; s < nFrames; s++)
+    {
+      delta *= coeff;
+      pRamp[s] = static_cast<sample>(target + delta);
+    }
+
+    // Snap once the remaining distance is inaudible, so that subsequent blocks are constant
+    if (std::abs(delta) <= 1e-6 * std::abs(mMax - mMin))
+      delta = 0.;
+
+    state.mValue = target + delta;
+  }
+}
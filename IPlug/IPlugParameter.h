@@ -65,6 +65,17 @@ public:
     kShapeExponential = 2,
     kShapeUnknown,
   };
+
+  /** Smoothing applied to the value seen by the audio thread, see SetSmoothing() */
+  enum ESmoothing
+  {
+    /** The value changes at the start of the block */
+    kSmoothNone = 0,
+    /** The value ramps linearly to a new target over the smoothing time */
+    kSmoothLinear,
+    /** The value approaches a new target exponentially, using a one pole lowpass with the same coefficient as LogParamSmooth */
+    kSmoothLog,
+  };
   
   /** DisplayFunc allows custom parameter display functions, defined by a lambda matching this signature */
   using DisplayFunc = std::function<void(double, WDL_String&)>;
@@ -286,7 +297,7 @@ public:
    * @return double The resulting constrained value */
   inline double ConstrainNormalized(double normalizedValue) const
   {
-    return ToNormalized(mShape->NormalizedToValue(normalizedValue, *this));
+    return ToNormalized(ShapeNormalizedToValue(normalizedValue));
   }
   
   /** Convert a real value to normalized value for this parameter
@@ -294,7 +305,7 @@ public:
    * @return The corresponding normalized value, for this parameter */
   inline double ToNormalized(double nonNormalizedValue) const
   {
-    return Clip(mShape->ValueToNormalized(Constrain(nonNormalizedValue), *this), 0., 1.);
+    return Clip(ShapeValueToNormalized(Constrain(nonNormalizedValue)), 0., 1.);
   }
 
   /** Convert a normalized value to real value for this parameter
@@ -302,9 +313,35 @@ public:
    * @return The corresponding real value, for this parameter */
   inline double FromNormalized(double normalizedValue) const
   {
-    return Constrain(mShape->NormalizedToValue(normalizedValue, *this));
+    return Constrain(ShapeNormalizedToValue(normalizedValue));
   }
 
+  /** Convert an array of normalized values to real values, with the same results as FromNormalized()
+   * @param pNormalized n normalized values in the range 0. to 1.
+   * @param pValues n real values to fill, which may be the same array as pNormalized
+   * @param n The number of values */
+  void FromNormalized(const double* pNormalized, double* pValues, int n) const;
+
+  /** Convert an array of real values to normalized values, with the same results as ToNormalized()
+   * @param pValues n real values
+   * @param pNormalized n normalized values to fill, which may be the same array as pValues
+   * @param n The number of values */
+  void ToNormalized(const double* pValues, double* pNormalized, int n) const;
+
+  /** Convert an array of normalized values to real values like FromNormalized(), but using approximations of pow() and exp() that the compiler can vectorize, e.g. for per sample modulation.
+   * The relative error is below 1e-8 for ShapePowCurve and ShapeExp, before stepping. ShapeLinear is exact, other shapes fall back to FromNormalized()
+   * @param pNormalized n normalized values in the range 0. to 1.
+   * @param pValues n real values to fill, which may be the same array as pNormalized
+   * @param n The number of values */
+  void FromNormalizedApprox(const double* pNormalized, double* pValues, int n) const;
+
+  /** Convert an array of real values to normalized values like ToNormalized(), but using approximations of pow() and log() that the compiler can vectorize.
+   * The absolute error is below 1e-8 for ShapePowCurve and ShapeExp. ShapeLinear is exact, other shapes fall back to ToNormalized()
+   * @param pValues n real values
+   * @param pNormalized n normalized values to fill, which may be the same array as pValues
+   * @param n The number of values */
+  void ToNormalizedApprox(const double* pValues, double* pNormalized, int n) const;
+
   /** Sets the parameter value
    * @param value Value to be set. Will be stepped and clamped between \c mMin and \c mMax */
   void Set(double value) { mValue.store(Constrain(value)); }
@@ -337,10 +374,21 @@ public:
    * @param label CString for the label */
   void SetLabel(const char* label) { strcpy(mLabel, label); }
   
-  /** Set the function to translate display values
+  /** Set the function to translate display values. Display strings made by a DisplayFunc are not cached, as they may depend on more than the value
    * @param func A function conforming to DisplayFunc */
   void SetDisplayFunc(DisplayFunc func) { mDisplayFunction = func; }
 
+  /** Set the ID that keys this parameter in compact state chunks. By default the ID is a hash of the name, so if a parameter is renamed between versions,
+   * call SetStableID(IParam::StableIDFromName("Old Name")) after Init to keep loading old sessions
+   * @param id The ID */
+  void SetStableID(uint32_t id) { mStableID = id; }
+
+  /** @return The ID that keys this parameter in compact state chunks, see SetStableID() */
+  uint32_t GetStableID() const { return mStableID; }
+
+  /** @return The 32-bit FNV-1a hash of a parameter name, which is the default stable ID */
+  static uint32_t StableIDFromName(const char* name);
+
   /** Gets a readable value of the parameter
    * @return double Current value of the parameter */
   double Value() const { return mValue.load(); }
@@ -368,7 +416,7 @@ public:
    * @param withDisplayText Should the output include display texts */
   void GetDisplay(WDL_String& display, bool withDisplayText = true) const { GetDisplay(mValue.load(), false, display, withDisplayText); }
 
-  /** Get the current textual display for a specified parameter value
+  /** Get the current textual display for a specified parameter value. The last string is cached, so asking again for the same value does not format it again
    * @param value The value to get the display for
    * @param normalized Is value normalized or real
    * @param display \c WDL_String to fill with the results
@@ -503,7 +551,115 @@ public:
 
   /** Helper to print the parameter details to debug console in debug builds */
   void PrintDetails() const;
+
+#pragma mark - Smoothing
+
+  /** Smooth the value seen by the audio thread. The API class then fills a ramp for this parameter before every ProcessBlock(), which can be read with GetSmoothedBlock().
+   * Call this in your plug-in constructor, after initializing the parameter. The ramp is allocated here for DEFAULT_BLOCK_SIZE frames, and grown by PrepareSmoothing()
+   * @param smoothing The kind of smoothing \see IParam::ESmoothing
+   * @param timeMs The smoothing time in milliseconds */
+  void SetSmoothing(ESmoothing smoothing, double timeMs = 20.);
+
+  /** @return The kind of smoothing \see IParam::ESmoothing */
+  ESmoothing GetSmoothing() const { return mSmoothing; }
+
+  /** @return The smoothing time in milliseconds */
+  double GetSmoothingTime() const { return mSmoothingTimeMs; }
+
+  /** Allocate the ramp for blocks of up to maxBlockSize frames. Called by the API class via IPluginBase::PrepareParamSmoothing() when the block size is set, you do not call this
+   * @param maxBlockSize The maximum number of frames the host will process in a block */
+  void PrepareSmoothing(int maxBlockSize);
+
+  /** Advance the smoothing by a block, filling the ramp with the smoothed value for each sample. Called by the API class via IPluginBase::ProcessParamSmoothing(), you do not call this
+   * @param sampleRate The current sample rate
+   * @param nFrames The number of frames in the block, which must not exceed the size passed to PrepareSmoothing() */
+  void ProcessSmoothing(double sampleRate, int nFrames);
+
+  /** Jump the smoothed value straight to the current value, e.g. on reset, so that the next block is constant */
+  void ResetSmoothing() { mSmoothingState.mValue = mSmoothingState.mTarget = Value(); mSmoothingState.mSamplesRemaining = 0; }
+
+  /** Audio thread only. If the value is constant this block, DSP can take a fast path using GetSmoothedValue(), rather than reading the ramp
+   * @return \c true if every sample of the ramp for the current block has the same value */
+  bool IsSmoothedBlockConstant() const { return mSmoothingState.mConstant; }
+
+  /** Audio thread only.
+   * @return The ramp for the current block, nFrames samples of the smoothed value. This is filled even when the block is constant */
+  const sample* GetSmoothedBlock() const { return mSmoothingState.mRamp.Get(); }
+
+  /** Audio thread only.
+   * @return The smoothed value at the end of the current block */
+  double GetSmoothedValue() const { return mSmoothingState.mValue; }
+
 private:
+  /** The shape's NormalizedToValue(), without a virtual call for the built in shapes */
+  inline double ShapeNormalizedToValue(double value) const
+  {
+    switch (mFastShapeID)
+    {
+      case kShapeLinear: return mMin + value * (mMax - mMin);
+      case kShapePowCurve: return mMin + std::pow(value, mShapeA) * (mMax - mMin);
+      case kShapeExponential: return std::exp(mShapeA + value * mShapeB);
+      default: return mShape->NormalizedToValue(value, *this);
+    }
+  }
+
+  /** The shape's ValueToNormalized(), without a virtual call for the built in shapes */
+  inline double ShapeValueToNormalized(double value) const
+  {
+    switch (mFastShapeID)
+    {
+      case kShapeLinear: return (value - mMin) / (mMax - mMin);
+      case kShapePowCurve: return std::pow((value - mMin) / (mMax - mMin), mShapeB);
+      case kShapeExponential: return (std::log(value) - mShapeA) / mShapeB;
+      default: return mShape->ValueToNormalized(value, *this);
+    }
+  }
+
+  /** Constrain() an array of values, testing the flags once rather than per value. pValues and pConstrained may be the same */
+  void ConstrainBlock(const double* pValues, double* pConstrained, int n) const;
+
+  /** The state of the smoothing, which is only accessed on the audio thread */
+  struct SmoothingState
+  {
+    double mValue = 0.;
+    double mTarget = 0.;
+    double mIncrement = 0.;
+    double mCoeff = 0.;
+    double mSampleRate = 0.;
+    int mSamplesRemaining = 0;
+    /** The number of samples at the start of mRamp that already hold mValue, so that a constant ramp need not be filled again */
+    int mConstantFrames = 0;
+    bool mConstant = true;
+    WDL_TypedBuf<sample> mRamp;
+  };
+
+  /** Format a display string, as GetDisplay() does for values that are not cached */
+  void FormatDisplay(double value, bool withDisplayText, WDL_String& display) const;
+
+  /** Forget the cached display strings, when something that affects them changes */
+  void InvalidateDisplayCache() { mDisplayGeneration.fetch_add(1); }
+
+  /** The last display string made by GetDisplay(), with and without display texts, so that repeated calls for the same value, e.g. from a generic editor or the host, do not format it again.
+   * GetDisplay() may be called on the UI and host threads at once, and the host may poll it often, so each entry is a seqlock rather than locked:
+   * a reader that overlaps a write sees a miss and formats the string itself, and a writer that finds another one writing leaves the entry to it */
+  struct DisplayCache
+  {
+    static constexpr int kNWords = (MAX_PARAM_DISPLAY_LEN + 7) / 8;
+
+    /** @return \c true if the entry holds the string for value, made in the current display generation, which is copied to str */
+    bool Read(double value, uint32_t generation, WDL_String& str) const;
+
+    /** Store the string for value, unless another thread is writing the entry */
+    void Write(double value, uint32_t generation, const char* text);
+
+    /** Odd while the entry is being written */
+    std::atomic<uint32_t> mSeq{0};
+    /** The display generation the string was made in, 0 if it has never been written */
+    std::atomic<uint32_t> mGeneration{0};
+    std::atomic<double> mValue{0.};
+    std::atomic<uint64_t> mText[kNWords] = {};
+  };
+
   /** A DisplayText is used to link a certain real value of the parameter with a CString. For example -70 on a decibel gain parameter could instead read "-inf" */
   struct DisplayText
   {
@@ -520,15 +676,31 @@ private:
   double mDefault = 0.0;
   int mDisplayPrecision = 0;
   int mFlags = 0;
+  uint32_t mStableID = 0;
 
   char mName[MAX_PARAM_NAME_LEN];
   char mLabel[MAX_PARAM_LABEL_LEN];
   char mParamGroup[MAX_PARAM_GROUP_LEN];
   
   std::unique_ptr<Shape> mShape;
+  /** The ID of mShape if it is exactly one of the built in shapes, so that conversions can switch on it rather than make virtual calls, otherwise kShapeUnknown */
+  EShapeIDs mFastShapeID = kShapeLinear;
+  /** The built in shape's constants: the exponent and its reciprocal for ShapePowCurve, mAdd and mMul for ShapeExp */
+  double mShapeA = 0.0;
+  double mShapeB = 0.0;
   DisplayFunc mDisplayFunction = nullptr;
 
   WDL_TypedBuf<DisplayText> mDisplayTexts;
+  /** \c true if the display texts are for the consecutive integers starting at mDisplayTexts[0].mValue, as for enums, so GetDisplayText() can index rather than search */
+  bool mDisplayTextsConsecutive = true;
+
+  mutable DisplayCache mDisplayCache[2];
+  /** Incremented when something that affects the display strings changes, which invalidates the cache entries made before */
+  std::atomic<uint32_t> mDisplayGeneration{1};
+
+  ESmoothing mSmoothing = kSmoothNone;
+  double mSmoothingTimeMs = 20.;
+  SmoothingState mSmoothingState;
 } WDL_FIXALIGN;
 
 END_IPLUG_NAMESPACE
@@ -13,10 +13,16 @@
  * @brief IPluginBase implementation
  */
 
+#include <cstddef>
+
 #include "IPlugPluginBase.h"
 #include "wdlendian.h"
 #include "wdl_base64.h"
 
+#ifdef IPLUG_STATE_COMPRESSION
+#include "zlib/zlib.h"
+#endif
+
 using namespace iplug;
 
 IPluginBase::IPluginBase(int nParams, int nPresets)
@@ -109,8 +115,12 @@ void IPluginBase::GetBuildInfoStr(WDL_String& str, const char* date, const char*
 bool IPluginBase::SerializeParams(IByteChunk& chunk) const
 {
   TRACE
+  if (mParamStateFlags & kParamStateCompact)
+    return SerializeParamsCompact(chunk);
+  
   bool savedOK = true;
   int i, n = mParams.GetSize();
+  chunk.Reserve(chunk.Size() + n * static_cast<int>(sizeof(double)));
   for (i = 0; i < n && savedOK; ++i)
   {
     IParam* pParam = mParams.Get(i);
@@ -122,28 +132,291 @@ bool IPluginBase::SerializeParams(IByteChunk& chunk) const
 }
 
 int IPluginBase::UnserializeParams(const IByteChunk& chunk, int startPos)
+{
+  return UnserializeParams(IByteStream(chunk.GetData(), chunk.Size()), startPos);
+}
+
+int IPluginBase::UnserializeParams(const IByteStream& stream, int startPos)
 {
   TRACE
-  int i, n = mParams.GetSize(), pos = startPos;
+  const int n = mParams.GetSize();
+  WDL_TypedBuf<double> values;
+  values.Resize(n);
+  const int pos = ReadParamValues(stream, startPos, values.Get());
+  
+  // The UI is updated by OnRestoreState(), which the API classes call after restoring state
+  mParamsRecalledInBulk = mBulkParamRecall;
+  
+  if (mBulkParamRecall)
+  {
+    ApplyParamValues(values.Get(), kPresetRecall, false);
+    return pos;
+  }
+  
   ENTER_PARAMS_MUTEX
-  for (i = 0; i < n && pos >= 0; ++i)
+  for (int i = 0; i < n; ++i)
   {
     IParam* pParam = mParams.Get(i);
-    double v = 0.0;
-    pos = chunk.Get(&v, pos);
-    if (pos >= 0)
+    pParam->Set(values.Get()[i]);
+    Trace(TRACELOC, "%d %s %f", i, pParam->GetName(), pParam->Value());
+  }
+
+  OnParamReset(kPresetRecall);
+  LEAVE_PARAMS_MUTEX
+
+  return pos;
+}
+
+int IPluginBase::UnserializeChangedParams(const IByteStream& stream, int startPos)
+{
+  TRACE
+  const int n = mParams.GetSize();
+  WDL_TypedBuf<double> values;
+  values.Resize(n);
+  const int pos = ReadParamValues(stream, startPos, values.Get());
+  
+  ApplyParamValues(values.Get(), kPresetRecall);
+  
+  return pos;
+}
+
+int IPluginBase::ApplyParamValues(const double* pValues, EParamSource source, bool sendToUI)
+{
+  TRACE
+  const int n = mParams.GetSize();
+  mChangedParams.clear();
+  mChangedParams.reserve(n);
+  
+  // Every value is set under one lock, so the audio thread sees either the old or the new snapshot, and nothing is notified until all are set
+  ENTER_PARAMS_MUTEX
+  for (int i = 0; i < n; ++i)
+  {
+    IParam* pParam = mParams.Get(i);
+    const double prev = pParam->Value();
+    pParam->Set(pValues[i]);
+    
+    if (pParam->Value() != prev)
     {
-      pParam->Set(v);
       Trace(TRACELOC, "%d %s %f", i, pParam->GetName(), pParam->Value());
+      mChangedParams.push_back(i);
     }
   }
-
-  OnParamReset(kPresetRecall);
+  
+  const int nChanged = static_cast<int>(mChangedParams.size());
+  
+  if (nChanged)
+    OnParamsChanged(mChangedParams.data(), nChanged, source);
   LEAVE_PARAMS_MUTEX
+  
+  if (nChanged && sendToUI)
+    SendParameterValuesFromDelegate(mChangedParams.data(), nChanged);
+  
+  return nChanged;
+}
+
+void IPluginBase::OnRestoreState()
+{
+  if (mParamsRecalledInBulk)
+  {
+    mParamsRecalledInBulk = false;
+    
+    if (mChangedParams.size())
+      SendParameterValuesFromDelegate(mChangedParams.data(), static_cast<int>(mChangedParams.size()));
+  }
+  else
+    SendCurrentParamValuesFromDelegate();
+}
 
+// Compact parameter state: a fixed header, followed by nEntries (uint32 stable ID, double value) pairs, which may be zlib compressed
+namespace
+{
+  struct ParamStateHeader
+  {
+    int32_t magic;
+    uint16_t version;
+    uint16_t flags;
+    int32_t nEntries;
+    int32_t rawSize;
+    int32_t storedSize;
+    uint32_t checksum; // of the fields above, so that legacy state which happens to start with the magic number is not mistaken for a header
+  };
+  
+  const int kParamStateHeaderSize = static_cast<int>(sizeof(ParamStateHeader));
+  const int kParamStateEntrySize = static_cast<int>(sizeof(uint32_t) + sizeof(double));
+  
+  /** 32-bit FNV-1a of the header, excluding the checksum itself */
+  uint32_t ParamStateHeaderChecksum(const ParamStateHeader& header)
+  {
+    const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(&header);
+    uint32_t hash = 2166136261u;
+    
+    for (size_t i = 0; i < offsetof(ParamStateHeader, checksum); i++)
+      hash = (hash ^ pBytes[i]) * 16777619u;
+    
+    return hash;
+  }
+  
+  /** Read and validate a compact state header
+   * @return The position after the header, or -1 if the data at startPos is not a compact state header */
+  int ReadParamStateHeader(const IByteStream& stream, int startPos, ParamStateHeader& header)
+  {
+    const int dataPos = stream.GetBytes(&header, kParamStateHeaderSize, startPos);
+    
+    if (dataPos < 0 || header.magic != IPLUG_PARAM_STATE_MAGIC || header.checksum != ParamStateHeaderChecksum(header))
+      return -1;
+    
+    if (header.nEntries < 0 || header.rawSize != header.nEntries * kParamStateEntrySize || header.storedSize < 0 || header.storedSize > stream.Size() - dataPos)
+      return -1;
+    
+    return dataPos;
+  }
+}
+
+int IPluginBase::ReadParamValues(const IByteStream& stream, int startPos, double* pValues) const
+{
+  ParamStateHeader header;
+  if (ReadParamStateHeader(stream, startPos, header) >= 0)
+    return ReadParamValuesCompact(stream, startPos, pValues);
+  
+  int i, n = mParams.GetSize(), pos = startPos;
+  
+  for (i = 0; i < n; ++i)
+    pValues[i] = mParams.Get(i)->Value();
+  
+  for (i = 0; i < n && pos >= 0; ++i)
+  {
+    double v = 0.0;
+    pos = stream.Get(&v, pos);
+    if (pos >= 0)
+      pValues[i] = v;
+  }
+  
   return pos;
 }
 
+bool IPluginBase::SerializeParamsCompact(IByteChunk& chunk) const
+{
+  const int n = mParams.GetSize();
+  const int headerPos = chunk.Size();
+  const int dataPos = headerPos + kParamStateHeaderSize;
+  
+  // Size the chunk for every value up front, and write the entries in place
+  chunk.Resize(dataPos + n * kParamStateEntrySize);
+  
+  uint8_t* pEntry = chunk.GetData() + dataPos;
+  int nEntries = 0;
+  
+  for (auto i = 0; i < n; i++)
+  {
+    const IParam* pParam = mParams.Get(i);
+    const double v = pParam->Value();
+    
+    if ((mParamStateFlags & kParamStateOmitDefaults) && v == pParam->GetDefault())
+      continue;
+    
+    const uint32_t id = pParam->GetStableID();
+    memcpy(pEntry, &id, sizeof(id));
+    memcpy(pEntry + sizeof(id), &v, sizeof(v));
+    pEntry += kParamStateEntrySize;
+    nEntries++;
+  }
+  
+  ParamStateHeader header {IPLUG_PARAM_STATE_MAGIC, IPLUG_PARAM_STATE_VERSION, 0, nEntries, nEntries * kParamStateEntrySize, nEntries * kParamStateEntrySize, 0};
+  
+#ifdef IPLUG_STATE_COMPRESSION
+  if ((mParamStateFlags & kParamStateCompress) && header.rawSize > 0)
+  {
+    WDL_TypedBuf<uint8_t> raw;
+    raw.Resize(header.rawSize);
+    memcpy(raw.Get(), chunk.GetData() + dataPos, header.rawSize);
+    
+    uLongf compressedSize = compressBound(static_cast<uLong>(header.rawSize));
+    chunk.Resize(dataPos + static_cast<int>(compressedSize));
+    
+    // Fall back to storing the values if compression fails, or does not make them smaller
+    if (compress2(chunk.GetData() + dataPos, &compressedSize, raw.Get(), static_cast<uLong>(header.rawSize), Z_BEST_SPEED) == Z_OK && static_cast<int>(compressedSize) < header.rawSize)
+    {
+      header.flags |= kParamStateCompress;
+      header.storedSize = static_cast<int32_t>(compressedSize);
+    }
+    else
+    {
+      memcpy(chunk.GetData() + dataPos, raw.Get(), header.rawSize);
+    }
+  }
+#endif
+  
+  chunk.Resize(dataPos + header.storedSize);
+  header.checksum = ParamStateHeaderChecksum(header);
+  memcpy(chunk.GetData() + headerPos, &header, kParamStateHeaderSize);
+  
+  return true;
+}
+
+int IPluginBase::ReadParamValuesCompact(const IByteStream& stream, int startPos, double* pValues) const
+{
+  ParamStateHeader header;
+  const int dataPos = ReadParamStateHeader(stream, startPos, header);
+  
+  if (dataPos < 0 || header.version > IPLUG_PARAM_STATE_VERSION)
+    return -1;
+  
+  // Uncompressed values are read in place, without copying
+  const uint8_t* pEntries = stream.GetData() + dataPos;
+  WDL_TypedBuf<uint8_t> raw;
+  
+  if (header.flags & kParamStateCompress)
+  {
+#ifdef IPLUG_STATE_COMPRESSION
+    raw.Resize(header.rawSize);
+    uLongf rawSize = static_cast<uLongf>(header.rawSize);
+    
+    if (uncompress(raw.Get(), &rawSize, pEntries, static_cast<uLong>(header.storedSize)) != Z_OK || static_cast<int>(rawSize) != header.rawSize)
+      return -1;
+    
+    pEntries = raw.Get();
+#else
+    assert(false && "Compressed parameter state requires IPLUG_STATE_COMPRESSION");
+    return -1;
+#endif
+  }
+  else if (header.storedSize != header.rawSize)
+  {
+    return -1;
+  }
+  
+  const int n = mParams.GetSize();
+  
+  // Parameters that are not in the chunk, either because they were at their default value or are new, take their default value
+  for (auto i = 0; i < n; i++)
+    pValues[i] = mParams.Get(i)->GetDefault();
+  
+  // Entries are written in index order, so the search for each ID starts after the previous match, which finds it straight away unless parameters have been added or reordered
+  int searchStart = 0;
+  
+  for (auto e = 0; e < header.nEntries && n > 0; e++, pEntries += kParamStateEntrySize)
+  {
+    uint32_t id;
+    double v;
+    memcpy(&id, pEntries, sizeof(id));
+    memcpy(&v, pEntries + sizeof(id), sizeof(v));
+    
+    for (auto j = 0; j < n; j++)
+    {
+      const int idx = (searchStart + j) % n;
+      
+      if (mParams.Get(idx)->GetStableID() == id)
+      {
+        pValues[idx] = v;
+        searchStart = idx + 1;
+        break;
+      }
+    }
+  }
+  
+  return dataPos + header.storedSize;
+}
+
 void IPluginBase::InitParamRange(int startIdx, int endIdx, int countStart, const char* nameFmtStr, double defaultVal, double minVal, double maxVal, double step, const char *label, int flags, const char *group, const IParam::Shape& shape, IParam::EParamUnit unit, IParam::DisplayFunc displayFunc)
 {
   WDL_String nameStr;
@@ -152,6 +425,8 @@ void IPluginBase::InitParamRange(int startIdx, int endIdx, int countStart, const
     nameStr.SetFormatted(MAX_PARAM_NAME_LEN, nameFmtStr, countStart + (p-startIdx));
     GetParam(p)->InitDouble(nameStr.Get(), defaultVal, minVal, maxVal, step, label, flags, group, shape, unit, displayFunc);
   }
+  
+  InvalidateParamIndex();
 }
 
 void IPluginBase::CloneParamRange(int cloneStartIdx, int cloneEndIdx, int startIdx, const char* searchStr, const char* replaceStr, const char* newGroup)
@@ -163,6 +438,8 @@ void IPluginBase::CloneParamRange(int cloneStartIdx, int cloneEndIdx, int startI
     GetParam(outIdx)->Init(*pParam, searchStr, replaceStr, newGroup);
     GetParam(outIdx)->Set(pParam->Value());
   }
+  
+  InvalidateParamIndex();
 }
 
 void IPluginBase::CopyParamValues(int startIdx, int destIdx, int nParams)
@@ -179,26 +456,21 @@ void IPluginBase::CopyParamValues(int startIdx, int destIdx, int nParams)
 
 void IPluginBase::CopyParamValues(const char* inGroup, const char *outGroup)
 {
-  WDL_PtrList<IParam> inParams, outParams;
+  const std::shared_ptr<const ParamIndex> index = GetParamIndex();
+  auto inIt = index->groups.find(inGroup);
+  auto outIt = index->groups.find(outGroup);
   
-  for (auto p = 0; p < NParams(); p++)
-  {
-    IParam* pParam = GetParam(p);
-    if(strcmp(pParam->GetGroup(), inGroup) == 0)
-    {
-      inParams.Add(pParam);
-    }
-    else if(strcmp(pParam->GetGroup(), outGroup) == 0)
-    {
-      outParams.Add(pParam);
-    }
-  }
+  if (inIt == index->groups.end() || outIt == index->groups.end())
+    return;
+  
+  const std::vector<int>& inParams = inIt->second;
+  const std::vector<int>& outParams = outIt->second;
   
-  assert(inParams.GetSize() == outParams.GetSize());
+  assert(inParams.size() == outParams.size());
   
-  for (auto p = 0; p < inParams.GetSize(); p++)
+  for (size_t p = 0; p < std::min(inParams.size(), outParams.size()); p++)
   {
-    outParams.Get(p)->Set(inParams.Get(p)->Value());
+    GetParam(outParams[p])->Set(GetParam(inParams[p])->Value());
   }
 }
 
@@ -212,14 +484,54 @@ void IPluginBase::ForParamInRange(int startIdx, int endIdx, std::function<void(i
 
 void IPluginBase::ForParamInGroup(const char* paramGroup, std::function<void (int paramIdx, IParam&)> func)
 {
-  for (auto p = 0; p < NParams(); p++)
+  // The index is held while iterating, so func may initialize parameters
+  const std::shared_ptr<const ParamIndex> index = GetParamIndex();
+  auto it = index->groups.find(paramGroup);
+  
+  if (it == index->groups.end())
+    return;
+  
+  for (auto p : it->second)
   {
-    IParam* pParam = GetParam(p);
-    if(strcmp(pParam->GetGroup(), paramGroup) == 0)
+    func(p, *GetParam(p));
+  }
+}
+
+int IPluginBase::GetParamIdxFromName(const char* name) const
+{
+  const std::shared_ptr<const ParamIndex> index = GetParamIndex();
+  auto it = index->names.find(name);
+  
+  return it != index->names.end() ? it->second : -1;
+}
+
+void IPluginBase::InvalidateParamIndex()
+{
+  WDL_MutexLock lock(&mParamIndexMutex);
+  mParamIndexDirty = true;
+}
+
+std::shared_ptr<const IPluginBase::ParamIndex> IPluginBase::GetParamIndex() const
+{
+  WDL_MutexLock lock(&mParamIndexMutex);
+  
+  if (!mParamIndex || mParamIndexDirty)
+  {
+    auto pIndex = std::make_shared<ParamIndex>();
+    pIndex->names.reserve(NParams());
+    
+    for (auto p = 0; p < NParams(); p++)
     {
-      func(p, *pParam);
+      const IParam* pParam = GetParam(p);
+      pIndex->names.emplace(pParam->GetName(), p); // keeps the first of any duplicate names
+      pIndex->groups[pParam->GetGroup()].push_back(p);
     }
+    
+    mParamIndex = pIndex;
+    mParamIndexDirty = false;
   }
+  
+  return mParamIndex;
 }
 
 void IPluginBase::DefaultParamValues()
@@ -264,6 +576,28 @@ void IPluginBase::PrintParamValues()
   });
 }
 
+void IPluginBase::PrepareParamSmoothing(int maxBlockSize)
+{
+  for (auto p = 0; p < NParams(); p++)
+  {
+    IParam* pParam = GetParam(p);
+
+    if (pParam->GetSmoothing() != IParam::kSmoothNone)
+      pParam->PrepareSmoothing(maxBlockSize);
+  }
+}
+
+void IPluginBase::ProcessParamSmoothing(double sampleRate, int nFrames)
+{
+  for (auto p = 0; p < NParams(); p++)
+  {
+    IParam* pParam = GetParam(p);
+
+    if (pParam->GetSmoothing() != IParam::kSmoothNone)
+      pParam->ProcessSmoothing(sampleRate, nFrames);
+  }
+}
+
 static IPreset* GetNextUninitializedPreset(WDL_PtrList<IPreset>* pPresets)
 {
   int n = pPresets->GetSize();
@@ -15,6 +15,11 @@
  * @copydoc IPluginBase
  */
 
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "IPlugDelegate_select.h"
 #include "IPlugParameter.h"
 #include "IPlugStructs.h"
@@ -129,16 +134,73 @@ public:
   /** @return \c true if the plug-in has been set up to do state chunks, via config.h */
   bool DoesStateChunks() const { return mStateChunks; }
   
-  /** Serializes the current double precision floating point, non-normalised values (IParam::mValue) of all parameters, into a binary byte chunk.
+  /** Choose the format written by SerializeParams(). The default, kParamStateLegacy, writes every value in index order.
+   * kParamStateCompact writes a versioned block keyed by IParam::GetStableID(), so parameters can be added, removed or reordered without breaking old sessions,
+   * and it can be combined with kParamStateOmitDefaults and kParamStateCompress to make chunks smaller. UnserializeParams() reads either format.
+   * NOTE: older builds of a plug-in can not read the compact format
+   * @param flags A combination of EParamStateFlags */
+  void SetParamStateFlags(int flags) { mParamStateFlags = flags; }
+  
+  /** @return The EParamStateFlags used by SerializeParams() */
+  int GetParamStateFlags() const { return mParamStateFlags; }
+  
+  /** Serializes the current double precision floating point, non-normalised values (IParam::mValue) of all parameters, into a binary byte chunk, in the format chosen with SetParamStateFlags().
    * @param chunk The output chunk to serialize to. Will append data if the chunk has already been started.
    * @return \c true if the serialization was successful */
   bool SerializeParams(IByteChunk& chunk) const;
   
-  /** Unserializes double precision floating point, non-normalised values from a byte chunk into mParams.
+  /** Unserializes double precision floating point, non-normalised values from a byte chunk into mParams. Either format written by SerializeParams() is accepted.
    * @param chunk The incoming chunk where parameter values are stored to unserialize
    * @param startPos The start position in the chunk where parameter values are stored
    * @return The new chunk position (endPos) */
   int UnserializeParams(const IByteChunk& chunk, int startPos);
+  
+  /** Unserializes parameter values from memory that is not owned by the plug-in, e.g. a host supplied state buffer, without copying it into an IByteChunk first.
+   * @param stream The incoming stream where parameter values are stored to unserialize
+   * @param startPos The start position in the stream where parameter values are stored
+   * @return The new stream position (endPos) */
+  int UnserializeParams(const IByteStream& stream, int startPos);
+  
+  /** Unserializes parameter values like UnserializeParams(), but applies them with ApplyParamValues(), so only the parameters whose values differ from the current ones are notified.
+   * Use this to switch quickly between presets which share most values. NOTE: an override of OnParamReset() is not called, OnParamsChanged() is called instead
+   * @param stream The incoming stream where parameter values are stored to unserialize
+   * @param startPos The start position in the stream where parameter values are stored
+   * @return The new stream position (endPos) */
+  int UnserializeChangedParams(const IByteStream& stream, int startPos);
+  
+  /** Apply a complete set of parameter values as one snapshot, notifying only the parameters whose values change. All of the values are set before anything is notified,
+   * then OnParamsChanged() is called once with the changed parameters, and the UI is updated once with SendParameterValuesFromDelegate().
+   * The host is not informed of each parameter, as this is used when it is restoring state. If the plug-in initiated the change, e.g. a preset browser, call InformHostOfPresetChange() afterwards
+   * @param pValues NParams() non-normalized values
+   * @param source Specifies the source of the parameter changes
+   * @param sendToUI \c false to leave updating the UI to the caller, e.g. OnRestoreState()
+   * @return The number of parameters whose values changed */
+  int ApplyParamValues(const double* pValues, EParamSource source = kPresetRecall, bool sendToUI = true);
+  
+  /** @return The parameters whose values changed in the last ApplyParamValues(), in ascending order */
+  const std::vector<int>& GetLastChangedParams() const { return mChangedParams; }
+  
+  /** @return \c true if the last UnserializeParams() applied values in bulk, and OnRestoreState() has not been called since. API classes check this after UnserializeState(), to inform the host of only GetLastChangedParams() */
+  bool GetParamsRecalledInBulk() const { return mParamsRecalledInBulk; }
+  
+  /** Called by API classes after restoring state and by RestorePreset(). After a bulk recall, see SetBulkParamRecall(), this sends only GetLastChangedParams() to the UI, otherwise it sends every parameter.
+   * If you override this method you should call this parent, in order to get controls to update when state is restored */
+  void OnRestoreState() override;
+  
+  /** Choose whether UnserializeParams(), and so the default UnserializeState(), applies values with ApplyParamValues(), rather than setting every parameter and calling OnParamReset().
+   * This makes state and preset recall much faster for plug-ins with many parameters, but an override of OnParamReset() is not called, OnParamsChanged() is called instead
+   * @param enable \c true to notify only the changed parameters, in bulk */
+  void SetBulkParamRecall(bool enable) { mBulkParamRecall = enable; }
+  
+  /** @return \c true if UnserializeParams() applies values in bulk, see SetBulkParamRecall() */
+  bool GetBulkParamRecall() const { return mBulkParamRecall; }
+  
+  /** Decode parameter values written by SerializeParams(), without applying them
+   * @param stream The incoming stream where parameter values are stored
+   * @param startPos The start position in the stream where parameter values are stored
+   * @param pValues NParams() non-normalized values to fill. Values missing from a compact chunk are the defaults, values missing from a legacy chunk are the current values
+   * @return The new stream position (endPos), or -1 if the data was incomplete */
+  int ReadParamValues(const IByteStream& stream, int startPos, double* pValues) const;
     
   /** Override this method to serialize custom state data, if your plugin does state chunks.
    * @param chunk The output bytechunk where data can be serialized
@@ -341,7 +403,15 @@ public:
    * @param func A lambda function to modify the parameter. Ideas: you could randomise the parameter value or reset to default, modify certain params based on their group */
   void ForParamInRange(int startIdx, int endIdx, std::function<void(int paramIdx, IParam& param)> func);
   
-  /** Modify a parameter group simulataneously
+  /** Find a parameter by name, using a hashed index which is built on the first lookup, and rebuilt after InitParamRange(), CloneParamRange() or InvalidateParamIndex()
+   * @param name The parameter name
+   * @return The index of the first parameter with the name, or -1 if there is none */
+  int GetParamIdxFromName(const char* name) const;
+
+  /** Rebuild the name and group index on the next lookup. Call this if you rename or regroup parameters with IParam::Init*() after GetParamIdxFromName(), ForParamInGroup() or CopyParamValues() has been used */
+  void InvalidateParamIndex();
+  
+  /** Modify a parameter group simulataneously. The group's parameters are found with a hashed index, like GetParamIdxFromName()
    * @param paramGroup The name of the group to modify
    * @param func A lambda function to modify the parameter. Ideas: you could randomise the parameter value or reset to default*/
   void ForParamInGroup(const char* paramGroup, std::function<void(int paramIdx, IParam& param)> func);
@@ -384,6 +454,17 @@ public:
   /** Default parameter values for a parameter group  */
   void PrintParamValues();
 
+  /** Allocate the ramps of every parameter that has smoothing set with IParam::SetSmoothing(), so that ProcessParamSmoothing() does not allocate.
+   * Called by the API class whenever the maximum block size is set, you do not call this
+   * @param maxBlockSize The maximum number of frames the host will process in a block */
+  void PrepareParamSmoothing(int maxBlockSize);
+
+  /** Advance every parameter that has smoothing set with IParam::SetSmoothing(), filling its ramp for the coming block.
+   * Called by the API class immediately before ProcessBlock(), you do not call this
+   * @param sampleRate The current sample rate
+   * @param nFrames The number of frames in the coming block */
+  void ProcessParamSmoothing(double sampleRate, int nFrames);
+
   friend class IPlugAPP;
   friend class IPlugAAX;
   friend class IPlugVST2;
@@ -397,7 +478,32 @@ public:
   friend class IPlugAPIBase;
   
 private:
+  /** Write the compact, ID keyed parameter state, see SetParamStateFlags() */
+  bool SerializeParamsCompact(IByteChunk& chunk) const;
+  
+  /** Decode the compact, ID keyed parameter state, starting at the magic number */
+  int ReadParamValuesCompact(const IByteStream& stream, int startPos, double* pValues) const;
+  
+  /** Indexes of the parameters by name and by group. An index is immutable once built, and is replaced on the next lookup after InvalidateParamIndex() */
+  struct ParamIndex
+  {
+    std::unordered_map<std::string, int> names;
+    /** The parameters in each group, in index order */
+    std::unordered_map<std::string, std::vector<int>> groups;
+  };
+  
+  /** @return The current index, rebuilding it if it has been invalidated since it was built */
+  std::shared_ptr<const ParamIndex> GetParamIndex() const;
+  
   int mCurrentPresetIdx = 0;
+  /** EParamStateFlags for the format written by SerializeParams() */
+  int mParamStateFlags = kParamStateLegacy;
+  /** \c true if UnserializeParams() uses ApplyParamValues() */
+  bool mBulkParamRecall = false;
+  /** \c true from a bulk UnserializeParams() until the following OnRestoreState() */
+  bool mParamsRecalledInBulk = false;
+  /** The parameters changed by the last ApplyParamValues(), kept to avoid allocating on every recall */
+  std::vector<int> mChangedParams;
   /** \c true if the plug-in does opaque state chunks. If false the host will provide a default interface */
   bool mStateChunks = false;
   /** The name of this plug-in */
@@ -432,6 +538,11 @@ private:
   WDL_PtrList<const char> mParamGroups;
   /** "Baked in" Factory presets */
   WDL_PtrList<IPreset> mPresets;
+  /** Lookups may come from the UI and host threads at once, so the index is swapped under a lock and shared with the lookups using it */
+  mutable WDL_Mutex mParamIndexMutex;
+  mutable std::shared_ptr<const ParamIndex> mParamIndex;
+  /** Set when parameters may have been renamed or regrouped, guarded by mParamIndexMutex */
+  mutable bool mParamIndexDirty = true;
 
 #ifdef PARAMS_MUTEX
   friend class IPlugVST3ProcessorBase;
@@ -35,24 +35,30 @@ IPlugProcessor::IPlugProcessor(const Config& config, EAPI plugAPI)
 
   mScratchData[ERoute::kInput].Resize(totalNInChans);
   mScratchData[ERoute::kOutput].Resize(totalNOutChans);
+  mAltScratchData[ERoute::kInput].Resize(totalNInChans);
+  mAltScratchData[ERoute::kOutput].Resize(totalNOutChans);
 
   sample** ppInData = mScratchData[ERoute::kInput].Get();
+  PLUG_SAMPLE_SRC** ppAltInData = mAltScratchData[ERoute::kInput].Get();
 
-  for (auto i = 0; i < totalNInChans; ++i, ++ppInData)
+  for (auto i = 0; i < totalNInChans; ++i, ++ppInData, ++ppAltInData)
   {
     IChannelData<>* pInChannel = new IChannelData<>;
     pInChannel->mConnected = false;
     pInChannel->mData = ppInData;
+    pInChannel->mAltData = ppAltInData;
     mChannelData[ERoute::kInput].Add(pInChannel);
   }
 
   sample** ppOutData = mScratchData[ERoute::kOutput].Get();
+  PLUG_SAMPLE_SRC** ppAltOutData = mAltScratchData[ERoute::kOutput].Get();
 
-  for (auto i = 0; i < totalNOutChans; ++i, ++ppOutData)
+  for (auto i = 0; i < totalNOutChans; ++i, ++ppOutData, ++ppAltOutData)
   {
     IChannelData<>* pOutChannel = new IChannelData<>;
     pOutChannel->mConnected = false;
     pOutChannel->mData = ppOutData;
+    pOutChannel->mAltData = ppAltOutData;
     pOutChannel->mIncomingData = nullptr;
     mChannelData[ERoute::kOutput].Add(pOutChannel);
   }
@@ -67,27 +73,35 @@ IPlugProcessor::~IPlugProcessor()
   mIOConfigs.Empty(true);
 }
 
-void IPlugProcessor::ProcessBlock(sample** inputs, sample** outputs, int nFrames)
+template <typename T>
+static void PassThroughBlock(T** inputs, T** outputs, int nIn, int nOut, int nFrames)
 {
-  const int nIn = mChannelData[ERoute::kInput].GetSize();
-  const int nOut = mChannelData[ERoute::kOutput].GetSize();
-
   int j = 0;
   for (int i = 0; i < nOut; ++i)
   {
     if (i < nIn)
     {
-      memcpy(outputs[i], inputs[i], nFrames * sizeof(sample));
+      memcpy(outputs[i], inputs[i], nFrames * sizeof(T));
       j++;
     }
   }
   // zero remaining outs
   for (/* same j */; j < nOut; ++j)
   {
-    memset(outputs[j], 0, nFrames * sizeof(sample));
+    memset(outputs[j], 0, nFrames * sizeof(T));
   }
 }
 
+void IPlugProcessor::ProcessBlock(sample** inputs, sample** outputs, int nFrames)
+{
+  PassThroughBlock(inputs, outputs, mChannelData[ERoute::kInput].GetSize(), mChannelData[ERoute::kOutput].GetSize(), nFrames);
+}
+
+void IPlugProcessor::ProcessBlockAltPrecision(PLUG_SAMPLE_SRC** inputs, PLUG_SAMPLE_SRC** outputs, int nFrames)
+{
+  PassThroughBlock(inputs, outputs, mChannelData[ERoute::kInput].GetSize(), mChannelData[ERoute::kOutput].GetSize(), nFrames);
+}
+
 void IPlugProcessor::ProcessMidiMsg(const IMidiMsg& msg)
 {
   SendMidiMsg(msg);
@@ -437,9 +451,13 @@ void IPlugProcessor::SetChannelConnections(ERoute direction, int idx, int n, boo
   {
     IChannelData<>* pChannel = channelData.Get(i);
     pChannel->mConnected = connected;
+    pChannel->mSilent = !connected; // the API class may subsequently report connected inputs as silent
 
     if (!connected)
+    {
       *(pChannel->mData) = pChannel->mScratchBuf.Get();
+      *(pChannel->mAltData) = pChannel->mAltScratchBuf.Get();
+    }
   }
 }
 
@@ -479,7 +497,14 @@ void IPlugProcessor::AttachBuffers(ERoute direction, int idx, int n, PLUG_SAMPLE
 
     if (pChannel->mConnected)
     {
-      if (direction == ERoute::kInput)
+      if (mAltPrecisionEnabled)
+      {
+        // The host buffers are passed to ProcessBlockAltPrecision() without conversion. The scratch buffers are only filled if ProcessBlock() is needed, see ConvertAltPrecisionInputs()
+        *(pChannel->mAltData) = *ppData;
+        *(pChannel->mData) = pChannel->mScratchBuf.Get();
+        pChannel->mIncomingData = *(ppData++);
+      }
+      else if (direction == ERoute::kInput)
       {
         PLUG_SAMPLE_DST* pScratch = pChannel->mScratchBuf.Get();
         CastCopy(pScratch, *(ppData++), nFrames);
@@ -496,6 +521,15 @@ void IPlugProcessor::AttachBuffers(ERoute direction, int idx, int n, PLUG_SAMPLE
 
 void IPlugProcessor::PassThroughBuffers(PLUG_SAMPLE_DST type, int nFrames)
 {
+  mSleeping = false;
+  mSilentFrames = 0;
+
+  for (auto i = 0; i < MaxNChannels(ERoute::kOutput); ++i)
+  {
+    IChannelData<>* pOutChannel = mChannelData[ERoute::kOutput].Get(i);
+    pOutChannel->mSilent = !pOutChannel->mConnected;
+  }
+
   if (mLatency && mLatencyDelay)
     mLatencyDelay->ProcessBlock(mScratchData[ERoute::kInput].Get(), mScratchData[ERoute::kOutput].Get(), nFrames);
   else
@@ -504,6 +538,9 @@ void IPlugProcessor::PassThroughBuffers(PLUG_SAMPLE_DST type, int nFrames)
 
 void IPlugProcessor::PassThroughBuffers(PLUG_SAMPLE_SRC type, int nFrames)
 {
+  if (mAltPrecisionEnabled)
+    ConvertAltPrecisionInputs(nFrames);
+
   // for PLUG_SAMPLE_SRC bit buffers, first run the delay (if mLatency) on the PLUG_SAMPLE_DST IPlug buffers
   PassThroughBuffers(PLUG_SAMPLE_DST(0.), nFrames);
 
@@ -522,11 +559,34 @@ void IPlugProcessor::PassThroughBuffers(PLUG_SAMPLE_SRC type, int nFrames)
 
 void IPlugProcessor::ProcessBuffers(PLUG_SAMPLE_DST type, int nFrames)
 {
-  ProcessBlock(mScratchData[ERoute::kInput].Get(), mScratchData[ERoute::kOutput].Get(), nFrames);
+  sample** ppOutData = mScratchData[ERoute::kOutput].Get();
+
+  if (UpdateSleeping(nFrames))
+  {
+    for (auto i = 0; i < MaxNChannels(ERoute::kOutput); ++i)
+      memset(ppOutData[i], 0, nFrames * sizeof(sample));
+  }
+  else
+    ProcessBlock(mScratchData[ERoute::kInput].Get(), ppOutData, nFrames);
 }
 
 void IPlugProcessor::ProcessBuffers(PLUG_SAMPLE_SRC type, int nFrames)
 {
+  if (mAltPrecisionEnabled)
+  {
+    PLUG_SAMPLE_SRC** ppOutData = mAltScratchData[ERoute::kOutput].Get();
+
+    if (UpdateSleeping(nFrames))
+    {
+      for (auto i = 0; i < MaxNChannels(ERoute::kOutput); ++i)
+        memset(ppOutData[i], 0, nFrames * sizeof(PLUG_SAMPLE_SRC));
+    }
+    else
+      ProcessBlockAltPrecision(mAltScratchData[ERoute::kInput].Get(), ppOutData, nFrames);
+
+    return;
+  }
+
   ProcessBuffers((PLUG_SAMPLE_DST) 0, nFrames);
   int i, n = MaxNChannels(ERoute::kOutput);
   IChannelData<>** ppOutChannel = mChannelData[ERoute::kOutput].GetList();
@@ -544,6 +604,9 @@ void IPlugProcessor::ProcessBuffers(PLUG_SAMPLE_SRC type, int nFrames)
 
 void IPlugProcessor::ProcessBuffersAccumulating(int nFrames)
 {
+  if (mAltPrecisionEnabled)
+    ConvertAltPrecisionInputs(nFrames);
+
   ProcessBuffers((PLUG_SAMPLE_DST) 0, nFrames);
   int i, n = MaxNChannels(ERoute::kOutput);
   IChannelData<>** ppOutChannel = mChannelData[ERoute::kOutput].GetList();
@@ -571,12 +634,14 @@ void IPlugProcessor::ZeroScratchBuffers()
   {
     IChannelData<>* pInChannel = mChannelData[ERoute::kInput].Get(i);
     memset(pInChannel->mScratchBuf.Get(), 0, mBlockSize * sizeof(PLUG_SAMPLE_DST));
+    memset(pInChannel->mAltScratchBuf.Get(), 0, pInChannel->mAltScratchBuf.GetSize() * sizeof(PLUG_SAMPLE_SRC));
   }
 
   for (i = 0; i < nOut; ++i)
   {
     IChannelData<>* pOutChannel = mChannelData[ERoute::kOutput].Get(i);
     memset(pOutChannel->mScratchBuf.Get(), 0, mBlockSize * sizeof(PLUG_SAMPLE_DST));
+    memset(pOutChannel->mAltScratchBuf.Get(), 0, pOutChannel->mAltScratchBuf.GetSize() * sizeof(PLUG_SAMPLE_SRC));
   }
 }
 
@@ -601,5 +666,79 @@ void IPlugProcessor::SetBlockSize(int blockSize)
     }
 
     mBlockSize = blockSize;
+
+    if (mAltPrecisionEnabled)
+      SetAltPrecisionEnabled(true);
+  }
+}
+
+void IPlugProcessor::SetAltPrecisionEnabled(bool enabled)
+{
+  mAltPrecisionEnabled = enabled;
+
+  // The PLUG_SAMPLE_SRC scratch buffers are used for unconnected channels, so are only needed when enabled
+  for (auto d = 0; d < 2; d++)
+  {
+    for (auto i = 0; i < mChannelData[d].GetSize(); ++i)
+    {
+      IChannelData<>* pChannel = mChannelData[d].Get(i);
+      pChannel->mAltScratchBuf.Resize(enabled ? mBlockSize : 0);
+
+      if (enabled)
+        memset(pChannel->mAltScratchBuf.Get(), 0, mBlockSize * sizeof(PLUG_SAMPLE_SRC));
+
+      if (!pChannel->mConnected)
+        *(pChannel->mAltData) = pChannel->mAltScratchBuf.Get();
+    }
+  }
+}
+
+bool IPlugProcessor::AllInputsSilent() const
+{
+  for (auto i = 0; i < MaxNChannels(ERoute::kInput); ++i)
+  {
+    if (!mChannelData[ERoute::kInput].Get(i)->mSilent)
+      return false;
+  }
+
+  return true;
+}
+
+bool IPlugProcessor::UpdateSleeping(int nFrames)
+{
+  // Sleep only once the input has been silent for longer than the tail, so the tail of the last sound is always processed
+  if (AllInputsSilent())
+  {
+    const bool tailExpired = !GetTailIsInfinite() && mSilentFrames >= GetTailSize();
+    mSilentFrames = std::min(mSilentFrames, kTailInfinite - nFrames) + nFrames;
+    mSleeping = tailExpired && CanSleep();
+  }
+  else
+  {
+    mSilentFrames = 0;
+    mSleeping = false;
+  }
+
+  // Outputs are only reported silent when sleeping, or if ProcessBlock() says so
+  for (auto i = 0; i < MaxNChannels(ERoute::kOutput); ++i)
+  {
+    IChannelData<>* pOutChannel = mChannelData[ERoute::kOutput].Get(i);
+    pOutChannel->mSilent = mSleeping || !pOutChannel->mConnected;
+  }
+
+  return mSleeping;
+}
+
+void IPlugProcessor::ConvertAltPrecisionInputs(int nFrames)
+{
+  // When alt precision is enabled, AttachBuffers() doesn't convert the inputs, so do it here if ProcessBlock() or the latency delay needs them
+  const int nIn = MaxNChannels(ERoute::kInput);
+
+  for (auto i = 0; i < nIn; ++i)
+  {
+    IChannelData<>* pInChannel = mChannelData[ERoute::kInput].Get(i);
+
+    if (pInChannel->mConnected)
+      CastCopy(pInChannel->mScratchBuf.Get(), pInChannel->mIncomingData, nFrames);
   }
 }
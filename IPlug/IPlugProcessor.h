@@ -69,6 +69,14 @@ public:
    * @param nFrames The block size for this block: number of samples per channel.*/
   virtual void ProcessBlock(sample** inputs, sample** outputs, int nFrames);
 
+  /** Optionally override in your plug-in class to process audio at the other precision, PLUG_SAMPLE_SRC (single precision, unless SAMPLE_TYPE_FLOAT is defined, in which case double precision).
+   * This is only called if you have enabled it with SetAltPrecisionEnabled(), and only when the host provides PLUG_SAMPLE_SRC buffers, which are then passed through without conversion or copying.
+   * Otherwise ProcessBlock() is called. The same guarantees and restrictions as ProcessBlock() apply.
+   * @param inputs Two-dimensional array containing the non-interleaved input buffers of audio samples for all channels
+   * @param outputs Two-dimensional array for audio output (non-interleaved).
+   * @param nFrames The block size for this block: number of samples per channel.*/
+  virtual void ProcessBlockAltPrecision(PLUG_SAMPLE_SRC** inputs, PLUG_SAMPLE_SRC** outputs, int nFrames);
+
   /** Override this method to handle incoming MIDI messages. The method is called prior to ProcessBlock().
    * You can use IMidiQueue in combination with this method in order to queue the message and process at the appropriate time in ProcessBlock()
    * THIS METHOD IS CALLED BY THE HIGH PRIORITY AUDIO THREAD - You should be careful not to do any unbounded, blocking operations such as file I/O which could cause audio dropouts
@@ -88,6 +96,12 @@ public:
    * @param active \c true if the host has activated the plug-in */
   virtual void OnActivate(bool active) { TRACE }
 
+  /** Override this method to allow the plug-in to sleep. When this returns \c true, all inputs are silent and the tail (see GetTailSize()) has expired, ProcessBlock() is not called and the outputs are filled with zeros.
+   * Instruments, or plug-ins that generate sound without input, should only return \c true when they are idle, e.g. when no voices are active.
+   * THIS METHOD IS CALLED BY THE HIGH PRIORITY AUDIO THREAD
+   * @return \c true if ProcessBlock() may be skipped once the input has been silent for longer than the tail */
+  virtual bool CanSleep() const { return false; }
+
 #pragma mark - Methods you can call - some of which have custom implementations in the API classes, some implemented in IPlugProcessor.cpp
 
   /** Send a single MIDI message // TODO: info about what thread should this be called on or not called on!
@@ -202,6 +216,24 @@ public:
    * @return The number of channels connected for output. WARNING: this assumes consecutive channel connections */
   inline int NOutChansConnected() const { return NChannelsConnected(ERoute::kOutput); }
 
+  /** Check if a channel is known to be silent in the current block. Unconnected channels are silent. For inputs this is only known if the API and host report it (CLAP, VST3)
+   * @param direction Whether this is an input or output channel
+   * @param chIdx The index of the channel to check
+   * @return \c true if the channel is silent */
+  bool IsChannelSilent(ERoute direction, int chIdx) const { return (chIdx < mChannelData[direction].GetSize() && mChannelData[direction].Get(chIdx)->mSilent); }
+
+  /** @return \c true if every input channel is known to be silent in the current block */
+  bool AllInputsSilent() const;
+
+  /** Call this from ProcessBlock() to tell the host that an output channel is silent this block, which allows it to skip processing downstream (CLAP, VST3).
+   * The channel must actually be filled with zeros
+   * @param chIdx The index of the output channel
+   * @param silent \c true if the channel is silent */
+  void SetOutputSilent(int chIdx, bool silent = true) { if (chIdx < mChannelData[ERoute::kOutput].GetSize()) mChannelData[ERoute::kOutput].Get(chIdx)->mSilent = silent; }
+
+  /** @return \c true if ProcessBlock() was skipped for the current block, see CanSleep() */
+  bool IsSleeping() const { return mSleeping; }
+
   /** Check if a certain configuration of input channels and output channels is allowed based on the channel I/O configs
    * @param NInputChans Number of inputs to test, if set to -1 = check NOutputChans only
    * @param NOutputChans Number of outputs to test, if set to -1 = check NInputChans only
@@ -251,6 +283,14 @@ public:
    * @param tailSize the new tailsize in samples*/
   virtual void SetTailSize(int tailSize) { mTailSize = tailSize; }
 
+  /** Call this from your plug-in constructor, OnReset() or OnActivate() to choose whether ProcessBlockAltPrecision() is called when the host provides PLUG_SAMPLE_SRC buffers.
+   * If your plug-in implements both ProcessBlock() and ProcessBlockAltPrecision(), enabling this avoids converting the host's buffers to and from the \c sample type. Do not call this while audio is being processed
+   * @param enabled \c true to call ProcessBlockAltPrecision() for PLUG_SAMPLE_SRC buffers */
+  void SetAltPrecisionEnabled(bool enabled);
+
+  /** @return \c true if ProcessBlockAltPrecision() is called when the host provides PLUG_SAMPLE_SRC buffers */
+  bool GetAltPrecisionEnabled() const { return mAltPrecisionEnabled; }
+
   /** A static method to parse the config.h channel I/O string.
    * @param IOStr Space separated cstring list of I/O configurations for this plug-in in the format ninchans-noutchans.
    * A hypen character \c(-) deliminates input-output. Supports multiple buses, which are indicated using a period \c(.) character.
@@ -267,6 +307,7 @@ public:
 protected:
 #pragma mark - Methods called by the API class - you do not call these methods in your plug-in class
   void SetChannelConnections(ERoute direction, int idx, int n, bool connected);
+  void SetInputSilent(int chIdx, bool silent) { if (chIdx < mChannelData[ERoute::kInput].GetSize()) mChannelData[ERoute::kInput].Get(chIdx)->mSilent = silent; }
   void InitLatencyDelay();
   
   //The following methods are duplicated, in order to deal with either single or double precision processing,
@@ -279,6 +320,8 @@ protected:
   void ProcessBuffers(PLUG_SAMPLE_DST type, int nFrames);
   void ProcessBuffersAccumulating(int nFrames); // only for VST2 deprecated method single precision
   void ZeroScratchBuffers();
+  void ConvertAltPrecisionInputs(int nFrames);
+  bool UpdateSleeping(int nFrames);
   void SetSampleRate(double sampleRate) { mSampleRate = sampleRate; }
   void SetBlockSize(int blockSize);
   void SetBypassed(bool bypassed) { mBypassed = bypassed; }
@@ -307,10 +350,18 @@ private:
   bool mBypassed = false;
   /** \c true if the plug-in is rendering off-line*/
   bool mRenderingOffline = false;
+  /** \c true if ProcessBlock() was skipped for the current block */
+  bool mSleeping = false;
+  /** The number of frames for which all inputs have been silent, up to kTailInfinite */
+  int mSilentFrames = 0;
   /** A list of IOConfig structures populated by ParseChannelIOStr in the IPlugProcessor constructor */
   WDL_PtrList<IOConfig> mIOConfigs;
   /* Manages pointers to the actual data for each channel */
   WDL_TypedBuf<sample*> mScratchData[2];
+  /* Manages pointers to the PLUG_SAMPLE_SRC data for each channel, passed to ProcessBlockAltPrecision() */
+  WDL_TypedBuf<PLUG_SAMPLE_SRC*> mAltScratchData[2];
+  /** \c true if ProcessBlockAltPrecision() is called for PLUG_SAMPLE_SRC buffers */
+  bool mAltPrecisionEnabled = false;
   /* A list of IChannelData structures corresponding to every input/output channel */
   WDL_PtrList<IChannelData<>> mChannelData[2];
   /** A multi-channel delay line used to delay the bypassed signal when a plug-in with latency is bypassed. */
@@ -210,12 +210,27 @@ public:
     return PutBytes(pRHS->GetData(), pRHS->Size());
   }
   
+  /** Allocates memory for a total of nBytes, so that subsequent Put calls up to that size do not reallocate. The size of the chunk is unchanged
+   * @param nBytes The total number of bytes to reserve */
+  inline void Reserve(int nBytes)
+  {
+    if (nBytes > Size())
+      mBytes.Prealloc(nBytes);
+  }
+  
   /** Clears the chunk (resizes to 0) */
   inline void Clear()
   {
     mBytes.Resize(0);
   }
-  
+
+  /** Exchanges the data of this chunk with another chunk, without copying it
+   * @param otherChunk The chunk to swap with */
+  inline void Swap(IByteChunk& otherChunk)
+  {
+    mBytes.SwapContentsWith(&otherChunk.mBytes);
+  }
+
   /** Returns the current size of the chunk
    * @return Current size (in bytes) */
   inline int Size() const
@@ -317,7 +332,7 @@ public:
   
   /** Gets a const ptr to the stream data
    * @return uint8_t* const ptr to the stream data */
-  inline const uint8_t* GetData()
+  inline const uint8_t* GetData() const
   {
     return mBytes;
   }
@@ -474,9 +489,12 @@ template<class TIN = PLUG_SAMPLE_SRC, class TOUT = PLUG_SAMPLE_DST>
 struct IChannelData
 {
   bool mConnected = false;
+  bool mSilent = true; // \c true if the channel is known to be silent in the current block
   TOUT** mData = nullptr; // If this is for an input channel, points into IPlugProcessor::mInData, if it's for an output channel points into IPlugProcessor::mOutData
   TIN* mIncomingData = nullptr;
+  TIN** mAltData = nullptr; // Points into IPlugProcessor::mAltScratchData, used when the plug-in processes at TIN precision
   WDL_TypedBuf<TOUT> mScratchBuf;
+  WDL_TypedBuf<TIN> mAltScratchBuf; // Only allocated if the plug-in processes at TIN precision
   WDL_String mLabel;
 };
 
@@ -33,6 +33,15 @@
 #include "IPlugConstants.h"
 #include "IPlugPlatform.h"
 
+#if defined IPLUG_SIMDE
+  #if defined(__arm64__)
+    #define SIMDE_ENABLE_NATIVE_ALIASES
+    #include "simde/x86/sse2.h"
+  #else
+    #include <emmintrin.h>
+  #endif
+#endif
+
 #ifdef OS_WIN
 #include <windows.h>
 #pragma warning(disable:4018 4267)	// size_t/signed/unsigned mismatch..
@@ -150,12 +159,61 @@ static inline void GetVersionStr(int versionInteger, WDL_String& str)
 template <class SRC, class DEST>
 void CastCopy(DEST* pDest, SRC* pSrc, int n)
 {
-  for (int i = 0; i < n; ++i, ++pDest, ++pSrc)
+  for (int i = 0; i < n; ++i)
   {
-    *pDest = (DEST) *pSrc;
+    pDest[i] = (DEST) pSrc[i];
   }
 }
 
+/** Overload of CastCopy() for buffers of the same type, which is a plain copy, or nothing if the buffers are the same
+ * @param pDest Ptr to the destination buffer
+ * @param pSrc Ptr to the source buffer
+ * @param n The number of or elements in the buffer */
+template <class T>
+void CastCopy(T* pDest, T* pSrc, int n)
+{
+  if (pDest != pSrc)
+    memcpy(pDest, pSrc, n * sizeof(T));
+}
+
+#if defined IPLUG_SIMDE
+/** Overload of CastCopy() converting single to double precision, four samples at a time */
+inline void CastCopy(double* pDest, float* pSrc, int n)
+{
+  int i = 0;
+
+  for (; i + 4 <= n; i += 4)
+  {
+    const __m128 v = _mm_loadu_ps(pSrc + i);
+    _mm_storeu_pd(pDest + i, _mm_cvtps_pd(v));
+    _mm_storeu_pd(pDest + i + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+  }
+
+  for (; i < n; ++i)
+  {
+    pDest[i] = (double) pSrc[i];
+  }
+}
+
+/** Overload of CastCopy() converting double to single precision, four samples at a time */
+inline void CastCopy(float* pDest, double* pSrc, int n)
+{
+  int i = 0;
+
+  for (; i + 4 <= n; i += 4)
+  {
+    const __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(pSrc + i));
+    const __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(pSrc + i + 2));
+    _mm_storeu_ps(pDest + i, _mm_movelh_ps(lo, hi));
+  }
+
+  for (; i < n; ++i)
+  {
+    pDest[i] = (float) pSrc[i];
+  }
+}
+#endif
+
 /** Converts a C string to lowercase
  * @param cDest Destination buffer for the lowercase string (must be pre-allocated)
  * @param cSrc Source string to convert */
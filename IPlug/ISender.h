@@ -21,7 +21,9 @@
 
 #include "IPlugPlatform.h"
 #include "IPlugQueue.h"
+#include <algorithm>
 #include <array>
+#include <cmath>
 
 #if defined OS_IOS || defined OS_MAC
 #include <Accelerate/Accelerate.h>
@@ -117,6 +119,194 @@ protected:
   ISenderData<MAXNC, T> mLastData;
 };
 
+/** Block kernels used for metering. Each keeps four independent accumulators, so that the loops vectorize without relaxed floating point math.
+ * On Apple platforms vDSP is used for float and double data */
+template <typename T>
+inline float MeterAbsMax(const T* pData, int n)
+{
+  T m0 = 0, m1 = 0, m2 = 0, m3 = 0;
+  int i = 0;
+
+  for (; i + 4 <= n; i += 4)
+  {
+    m0 = std::max(m0, static_cast<T>(std::fabs(pData[i])));
+    m1 = std::max(m1, static_cast<T>(std::fabs(pData[i + 1])));
+    m2 = std::max(m2, static_cast<T>(std::fabs(pData[i + 2])));
+    m3 = std::max(m3, static_cast<T>(std::fabs(pData[i + 3])));
+  }
+
+  for (; i < n; i++)
+    m0 = std::max(m0, static_cast<T>(std::fabs(pData[i])));
+
+  return static_cast<float>(std::max(std::max(m0, m1), std::max(m2, m3)));
+}
+
+/** @copydoc MeterAbsMax */
+template <typename T>
+inline float MeterSumAbs(const T* pData, int n)
+{
+  T s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  int i = 0;
+
+  for (; i + 4 <= n; i += 4)
+  {
+    s0 += std::fabs(pData[i]);
+    s1 += std::fabs(pData[i + 1]);
+    s2 += std::fabs(pData[i + 2]);
+    s3 += std::fabs(pData[i + 3]);
+  }
+
+  for (; i < n; i++)
+    s0 += std::fabs(pData[i]);
+
+  return static_cast<float>((s0 + s1) + (s2 + s3));
+}
+
+/** @copydoc MeterAbsMax */
+template <typename T>
+inline float MeterSumSquares(const T* pData, int n)
+{
+  T s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  int i = 0;
+
+  for (; i + 4 <= n; i += 4)
+  {
+    s0 += pData[i] * pData[i];
+    s1 += pData[i + 1] * pData[i + 1];
+    s2 += pData[i + 2] * pData[i + 2];
+    s3 += pData[i + 3] * pData[i + 3];
+  }
+
+  for (; i < n; i++)
+    s0 += pData[i] * pData[i];
+
+  return static_cast<float>((s0 + s1) + (s2 + s3));
+}
+
+#if defined OS_IOS || defined OS_MAC
+template <>
+inline float MeterAbsMax(const float* pData, int n) { float r = 0.f; vDSP_maxmgv(pData, 1, &r, n); return r; }
+
+template <>
+inline float MeterAbsMax(const double* pData, int n) { double r = 0.; vDSP_maxmgvD(pData, 1, &r, n); return static_cast<float>(r); }
+
+template <>
+inline float MeterSumAbs(const float* pData, int n) { float r = 0.f; vDSP_svemg(pData, 1, &r, n); return r; }
+
+template <>
+inline float MeterSumAbs(const double* pData, int n) { double r = 0.; vDSP_svemgD(pData, 1, &r, n); return static_cast<float>(r); }
+
+template <>
+inline float MeterSumSquares(const float* pData, int n) { float r = 0.f; vDSP_svesq(pData, 1, &r, n); return r; }
+
+template <>
+inline float MeterSumSquares(const double* pData, int n) { double r = 0.; vDSP_svesqD(pData, 1, &r, n); return static_cast<float>(r); }
+#endif
+
+/** Measures the true (inter-sample) peak of blocks of samples, by 4x oversampling with a 48 tap polyphase windowed sinc filter, as described in ITU-R BS.1770.
+ * The filter runs a phase at a time over spans of up to kSpanSize samples, so the inner loops vectorize */
+template <int MAXNC = 1>
+class TruePeakDetector
+{
+public:
+  static constexpr int kOversampling = 4;
+  static constexpr int kTapsPerPhase = 12;
+  static constexpr int kSpanSize = 64;
+
+  TruePeakDetector()
+  {
+    Reset();
+  }
+
+  void Reset()
+  {
+    for (auto& history : mHistory)
+      history.fill(0.f);
+  }
+
+  /** @return The largest absolute value of the 4x oversampled signal over a block of one channel
+   * @param chan The channel, which selects the filter history
+   * @param pData The samples
+   * @param nFrames The number of samples */
+  template <typename T>
+  float Process(int chan, const T* pData, int nFrames)
+  {
+    const Coefficients& coeffs = GetCoefficients();
+    std::array<float, kTapsPerPhase - 1>& history = mHistory[chan];
+    float buffer[kTapsPerPhase - 1 + kSpanSize];
+    float output[kSpanSize];
+    float peak = 0.f;
+
+    for (auto start = 0; start < nFrames; start += kSpanSize)
+    {
+      const int n = std::min(kSpanSize, nFrames - start);
+
+      std::copy(history.begin(), history.end(), buffer);
+
+      for (auto i = 0; i < n; i++)
+        buffer[kTapsPerPhase - 1 + i] = static_cast<float>(pData[start + i]);
+
+      // Zero a short final span, so that every span is filtered with the same fixed trip count. Only the first n outputs are used
+      std::fill(buffer + kTapsPerPhase - 1 + n, buffer + kTapsPerPhase - 1 + kSpanSize, 0.f);
+
+      for (auto p = 0; p < kOversampling; p++)
+      {
+        std::fill(output, output + kSpanSize, 0.f);
+
+        for (auto k = 0; k < kTapsPerPhase; k++)
+        {
+          const float h = coeffs[p][k];
+
+          for (auto i = 0; i < kSpanSize; i++)
+            output[i] += h * buffer[i + k];
+        }
+
+        peak = std::max(peak, MeterAbsMax(output, n));
+      }
+
+      std::copy(buffer + n, buffer + n + kTapsPerPhase - 1, history.begin());
+    }
+
+    return peak;
+  }
+
+private:
+  using Coefficients = std::array<std::array<float, kTapsPerPhase>, kOversampling>;
+
+  /** The Hann windowed sinc prototype, split into phases ordered so that the newest sample is multiplied by the last coefficient. Each phase is normalized to unity gain at DC */
+  static const Coefficients& GetCoefficients()
+  {
+    static const Coefficients coeffs = []() {
+      constexpr int nTaps = kOversampling * kTapsPerPhase;
+      Coefficients c;
+
+      for (auto p = 0; p < kOversampling; p++)
+      {
+        double sum = 0.;
+
+        for (auto k = 0; k < kTapsPerPhase; k++)
+        {
+          const int tap = kOversampling * (kTapsPerPhase - 1 - k) + p;
+          const double x = static_cast<double>(tap - nTaps / 2) / kOversampling;
+          const double sinc = x == 0. ? 1. : std::sin(PI * x) / (PI * x);
+          const double window = 0.5 - 0.5 * std::cos(2. * PI * tap / nTaps);
+          c[p][k] = static_cast<float>(sinc * window);
+          sum += c[p][k];
+        }
+
+        for (auto k = 0; k < kTapsPerPhase; k++)
+          c[p][k] = static_cast<float>(c[p][k] / sum);
+      }
+
+      return c;
+    }();
+
+    return coeffs;
+  }
+
+  std::array<std::array<float, kTapsPerPhase - 1>, MAXNC> mHistory;
+};
+
 /** IPeakSender is a utility class which can be used to defer peak data from sample buffers for sending to the GUI
  * It sends the average peak value over a certain time window.
  */
@@ -140,7 +330,8 @@ public:
   void SetWindowSizeMs(double timeMs, double sampleRate)
   {
     mWindowSizeMs = static_cast<float>(timeMs);
-    mWindowSize = static_cast<int>(timeMs * 0.001 * sampleRate);
+    mWindowSize = std::max(static_cast<int>(timeMs * 0.001 * sampleRate), 1);
+    mCount = 0;
   }
   
   /** Queue peaks from sample buffers into the sender This can be called on the realtime audio thread.
@@ -151,7 +342,8 @@ public:
    @param chanOffset the starting channel */
   void ProcessBlock(sample** inputs, int nFrames, int ctrlTag = kNoTag, int nChans = MAXNC, int chanOffset = 0)
   {
-    for (auto s = 0; s < nFrames; s++)
+    // Process spans up to the end of each window, with a block kernel for each channel
+    for (auto s = 0; s < nFrames;)
     {
       if (mCount == 0)
       {
@@ -172,13 +364,18 @@ public:
         mPreviousSum = sum;
       }
       
+      const int n = std::min(nFrames - s, mWindowSize - mCount);
+      
       for (auto c = chanOffset; c < (chanOffset + nChans); c++)
       {
-        mPeaks[c] += std::fabs(static_cast<float>(inputs[c][s]));
+        mPeaks[c] += MeterSumAbs(inputs[c] + s, n);
       }
       
-      mCount++;
-      mCount %= mWindowSize;
+      s += n;
+      mCount += n;
+      
+      if (mCount == mWindowSize)
+        mCount = 0;
     }
   }
 private:
@@ -191,7 +388,7 @@ private:
 };
 
 /** IPeakAvgSender is a utility class which can be used to defer peak & avg/RMS data from sample buffers for sending to the GUI
- * It also features an envelope follower to control meter ballistics
+ * It also features an envelope follower to control meter ballistics, which runs once per window
  */
 template <int MAXNC = 1, int QUEUE_SIZE = 64>
 class IPeakAvgSender : public ISender<MAXNC, QUEUE_SIZE, std::pair<float, float>>
@@ -233,10 +430,11 @@ public:
     float mPreviousOutput = 0.0f;
   };
   
-  IPeakAvgSender(double minThresholdDb = -90.0, bool rmsMode = true, float windowSizeMs = 5.0f, float attackTimeMs = 1.0f, float decayTimeMs = 100.0f, float peakHoldTimeMs = 500.0f)
+  IPeakAvgSender(double minThresholdDb = -90.0, bool rmsMode = true, float windowSizeMs = 5.0f, float attackTimeMs = 1.0f, float decayTimeMs = 100.0f, float peakHoldTimeMs = 500.0f, bool truePeakMode = false)
   : ISender<MAXNC, QUEUE_SIZE, std::pair<float, float>>()
   , mThreshold(static_cast<float>(DBToAmp(minThresholdDb)))
   , mRMSMode(rmsMode)
+  , mTruePeakMode(truePeakMode)
   , mWindowSizeMs(windowSizeMs)
   , mAttackTimeMs(attackTimeMs)
   , mDecayTimeMs(decayTimeMs)
@@ -252,6 +450,7 @@ public:
     SetDecayTimeMs(mDecayTimeMs, sampleRate);
     SetPeakHoldTimeMs(mPeakHoldTimeMs, sampleRate);
     std::fill(mHeldPeaks.begin(), mHeldPeaks.end(), 0.0f);
+    mTruePeakDetector.Reset();
   }
   
   void SetAttackTimeMs(double timeMs, double sampleRate)
@@ -269,13 +468,10 @@ public:
   void SetWindowSizeMs(double timeMs, double sampleRate)
   {
     mWindowSizeMs = static_cast<float>(timeMs);
-    mWindowSize = static_cast<int>(timeMs * 0.001 * sampleRate);
-
-    for (auto i=0; i<MAXNC; i++)
-    {
-      mBuffers[i].resize(mWindowSize);
-      std::fill(mBuffers[i].begin(), mBuffers[i].end(), 0.0f);
-    }
+    mWindowSize = std::max(static_cast<int>(timeMs * 0.001 * sampleRate), 1);
+    mCount = 0;
+    std::fill(mWindowPeaks.begin(), mWindowPeaks.end(), 0.0f);
+    std::fill(mWindowSums.begin(), mWindowSums.end(), 0.0f);
   }
   
   void SetPeakHoldTimeMs(double timeMs, double sampleRate)
@@ -285,6 +481,14 @@ public:
     std::fill(mPeakHoldCounters.begin(), mPeakHoldCounters.end(), mPeakHoldTime);
   }
   
+  /** Measure the true (inter-sample) peak, rather than the sample peak. This costs more CPU
+   * @param truePeakMode \c true to measure the true peak */
+  void SetTruePeakMode(bool truePeakMode)
+  {
+    mTruePeakMode = truePeakMode;
+    mTruePeakDetector.Reset();
+  }
+  
   /** Queue peaks from sample buffers into the sender This can be called on the realtime audio thread.
    @param inputs the sample buffers to analyze
    @param nFrames the number of sample frames in the input buffers
@@ -293,124 +497,108 @@ public:
    @param chanOffset the starting channel */
   void ProcessBlock(sample** inputs, int nFrames, int ctrlTag = kNoTag, int nChans = MAXNC, int chanOffset = 0)
   {
-    for (auto s = 0; s < nFrames; s++)
+    // Process spans up to the end of each window, accumulating the peak and sum with block kernels for each channel
+    for (auto s = 0; s < nFrames;)
     {
-      int windowPos = s % mWindowSize;
+      const int n = std::min(nFrames - s, mWindowSize - mCount);
       
       for (auto c = chanOffset; c < (chanOffset + nChans); c++)
       {
-        mBuffers[c][windowPos] = static_cast<float>(inputs[c][s]);
+        const sample* pData = inputs[c] + s;
+        const float peakVal = mTruePeakMode ? mTruePeakDetector.Process(c, pData, n) : MeterAbsMax(pData, n);
+        mWindowPeaks[c] = std::max(mWindowPeaks[c], peakVal);
+        mWindowSums[c] += mRMSMode ? MeterSumSquares(pData, n) : MeterSumAbs(pData, n);
       }
       
-      if (mCount == 0)
+      s += n;
+      mCount += n;
+      
+      if (mCount == mWindowSize)
       {
-        ISenderData<MAXNC, std::pair<float, float>> d {ctrlTag, nChans, chanOffset};
-        
-        auto avgSum = 0.0f;
-        
-        for (auto c = chanOffset; c < (chanOffset + nChans); c++)
-        {
-          auto peakVal = 0.0f;
-          auto avgVal = 0.0f;
-#if defined OS_IOS || defined OS_MAC
-          vDSP_vabs(mBuffers[c].data(), 1, mBuffers[c].data(), 1, mWindowSize);
-          vDSP_maxv(mBuffers[c].data(), 1, &peakVal, mWindowSize);
-          
-          if (mRMSMode)
-          {
-            vDSP_rmsqv(mBuffers[c].data(), 1, &avgVal, mWindowSize);
-          }
-          else
-          {
-            vDSP_meanv(mBuffers[c].data(), 1, &avgVal, mWindowSize);
-          }
-#else
-          for (auto i=0; i<mWindowSize; i++)
-          {
-            auto absVal = std::fabs(mBuffers[c][i]);
-            
-            if (absVal > peakVal)
-            {
-              peakVal = absVal;
-            }
-            
-            if (mRMSMode)
-            {
-              absVal = absVal * absVal;
-            }
-            
-            avgVal += absVal;
-          }
-          
-          avgVal /= static_cast<float>(mWindowSize);
-          
-          if (mRMSMode)
-          {
-            avgVal = std::sqrt(avgVal);
-          }
-#endif
+        mCount = 0;
+        ProcessWindow(ctrlTag, nChans, chanOffset);
+      }
+    }
+  }
+
+private:
+  /** Update the peak hold and envelope followers at the end of a window, and queue the data */
+  void ProcessWindow(int ctrlTag, int nChans, int chanOffset)
+  {
+    ISenderData<MAXNC, std::pair<float, float>> d {ctrlTag, nChans, chanOffset};
+    
+    auto avgSum = 0.0f;
+    
+    for (auto c = chanOffset; c < (chanOffset + nChans); c++)
+    {
+      const auto peakVal = mWindowPeaks[c];
+      auto avgVal = mWindowSums[c] / static_cast<float>(mWindowSize);
       
-          // set peak-hold value
-          if (mPeakHoldCounters[c] <= 0)
-          {
-            mHeldPeaks[c] = 0.0f;
-          }
-          
-          if (mHeldPeaks[c] < peakVal)
-          {
-            mHeldPeaks[c] = peakVal;
-            mPeakHoldCounters[c] = mPeakHoldTime;
-          }
-          else
-          {
-            if (mPeakHoldCounters[c] > 0)
-            {
-              mPeakHoldCounters[c] -= mWindowSize;
-            }
-          }
-          
-          std::get<0>(d.vals[c]) = mHeldPeaks[c];
-          
-          // set avg value
-          auto smoothedAvg = mEnvFollowers[c].Process(avgVal, mAttackTimeSamples, mDecayTimeSamples);
-          std::get<1>(d.vals[c]) = smoothedAvg;
-          
-          avgSum += smoothedAvg;
-        }
-        
-        if (mPreviousSum > mThreshold)
-        {
-          ISender<MAXNC, QUEUE_SIZE, std::pair<float, float>>::PushData(d);
-        }
-        else
+      if (mRMSMode)
+      {
+        avgVal = std::sqrt(avgVal);
+      }
+      
+      mWindowPeaks[c] = 0.0f;
+      mWindowSums[c] = 0.0f;
+      
+      // set peak-hold value
+      if (mPeakHoldCounters[c] <= 0)
+      {
+        mHeldPeaks[c] = 0.0f;
+      }
+      
+      if (mHeldPeaks[c] < peakVal)
+      {
+        mHeldPeaks[c] = peakVal;
+        mPeakHoldCounters[c] = mPeakHoldTime;
+      }
+      else
+      {
+        if (mPeakHoldCounters[c] > 0)
         {
-          // This makes sure that the data is still pushed if
-          // peakholds are still active
-          bool counterActive = false;
-          
-          for (auto c = chanOffset; c < (chanOffset + nChans); c++)
-          {
-            counterActive &= mPeakHoldCounters[c] > 0;
-            std::get<0>(d.vals[c]) = 0.0f;
-            std::get<1>(d.vals[c]) = 0.0f;
-          }
-          
-          if (counterActive)
-          {
-            ISender<MAXNC, QUEUE_SIZE, std::pair<float, float>>::PushData(d);
-          }
+          mPeakHoldCounters[c] -= mWindowSize;
         }
-        
-        mPreviousSum = avgSum;
       }
       
-      mCount++;
-      mCount %= mWindowSize;
+      std::get<0>(d.vals[c]) = mHeldPeaks[c];
+      
+      // set avg value
+      auto smoothedAvg = mEnvFollowers[c].Process(avgVal, mAttackTimeSamples, mDecayTimeSamples);
+      std::get<1>(d.vals[c]) = smoothedAvg;
+      
+      avgSum += smoothedAvg;
+    }
+    
+    if (mPreviousSum > mThreshold)
+    {
+      ISender<MAXNC, QUEUE_SIZE, std::pair<float, float>>::PushData(d);
     }
+    else
+    {
+      // This makes sure that the data is still pushed if
+      // peakholds are still active
+      bool counterActive = false;
+      
+      for (auto c = chanOffset; c < (chanOffset + nChans); c++)
+      {
+        counterActive &= mPeakHoldCounters[c] > 0;
+        std::get<0>(d.vals[c]) = 0.0f;
+        std::get<1>(d.vals[c]) = 0.0f;
+      }
+      
+      if (counterActive)
+      {
+        ISender<MAXNC, QUEUE_SIZE, std::pair<float, float>>::PushData(d);
+      }
+    }
+    
+    mPreviousSum = avgSum;
   }
-private:
+
   float mThreshold = 0.01f;
   bool mRMSMode = false;
+  bool mTruePeakMode = false;
   float mPreviousSum = 1.0f;
   int mWindowSize = 32;
   int mPeakHoldTime = 1 << 16;
@@ -422,9 +610,11 @@ private:
   float mAttackTimeSamples = 1.0f;
   float mDecayTimeSamples = DEFAULT_SAMPLE_RATE/10.0f;
   std::array<float, MAXNC> mHeldPeaks = {0};
-  std::array<std::vector<float>, MAXNC> mBuffers;
+  std::array<float, MAXNC> mWindowPeaks = {0};
+  std::array<float, MAXNC> mWindowSums = {0};
   std::array<int, MAXNC> mPeakHoldCounters;
   std::array<EnvelopeFollower, MAXNC> mEnvFollowers;
+  TruePeakDetector<MAXNC> mTruePeakDetector;
 };
 
 /** IBufferSender is a utility class which can be used to defer buffer data for sending to the GUI */
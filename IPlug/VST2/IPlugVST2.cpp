@@ -433,6 +433,7 @@ VstIntPtr VSTCALLBACK IPlugVST2::VSTDispatcher(AEffect *pEffect, VstInt32 opCode
     case effSetBlockSize:
     {
       _this->SetBlockSize((int) value);
+      _this->PrepareParamSmoothing((int) value);
       _this->OnReset();
       return 0;
     }
@@ -987,6 +988,7 @@ void VSTCALLBACK IPlugVST2::VSTProcess(AEffect* pEffect, float** inputs, float**
   IPlugVST2* _this = (IPlugVST2*) pEffect->object;
   _this->VSTPreProcess(inputs, outputs, nFrames);
   ENTER_PARAMS_MUTEX_STATIC
+  _this->ProcessParamSmoothing(_this->GetSampleRate(), nFrames);
   _this->ProcessBuffersAccumulating(nFrames);
   LEAVE_PARAMS_MUTEX_STATIC
   _this->OutputSysexFromEditor();
@@ -998,6 +1000,7 @@ void VSTCALLBACK IPlugVST2::VSTProcessReplacing(AEffect* pEffect, float** inputs
   IPlugVST2* _this = (IPlugVST2*) pEffect->object;
   _this->VSTPreProcess(inputs, outputs, nFrames);
   ENTER_PARAMS_MUTEX_STATIC
+  _this->ProcessParamSmoothing(_this->GetSampleRate(), nFrames);
   _this->ProcessBuffers((float) 0.0f, nFrames);
   LEAVE_PARAMS_MUTEX_STATIC
   _this->OutputSysexFromEditor();
@@ -1009,6 +1012,7 @@ void VSTCALLBACK IPlugVST2::VSTProcessDoubleReplacing(AEffect* pEffect, double**
   IPlugVST2* _this = (IPlugVST2*) pEffect->object;
   _this->VSTPreProcess(inputs, outputs, nFrames);
   ENTER_PARAMS_MUTEX_STATIC
+  _this->ProcessParamSmoothing(_this->GetSampleRate(), nFrames);
   _this->ProcessBuffers((double) 0.0, nFrames);
   LEAVE_PARAMS_MUTEX_STATIC
   _this->OutputSysexFromEditor();
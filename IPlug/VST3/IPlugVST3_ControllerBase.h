@@ -335,10 +335,18 @@ public:
   
   void UpdateParams(IPlugAPIBase* pPlug, int savedBypass)
   {
-    for (int i = 0; i < pPlug->NParams(); i++)
+    if (pPlug->GetParamsRecalledInBulk())
+    {
+      for (int paramIdx : pPlug->GetLastChangedParams())
+        mParameters.getParameter(paramIdx)->setNormalized(pPlug->GetParam(paramIdx)->GetNormalized());
+    }
+    else
     {
-      double normalized = pPlug->GetParam(i)->GetNormalized();
-      mParameters.getParameter(i)->setNormalized(normalized);
+      for (int i = 0; i < pPlug->NParams(); i++)
+      {
+        double normalized = pPlug->GetParam(i)->GetNormalized();
+        mParameters.getParameter(i)->setNormalized(normalized);
+      }
     }
     
     if (mBypassParameter)
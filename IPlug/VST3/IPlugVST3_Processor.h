@@ -62,6 +62,7 @@ public:
   void SendControlValueFromDelegate(int ctrlTag, double normalizedValue) override;
   void SendControlMsgFromDelegate(int ctrlTag, int msgTag, int dataSize, const void* pData) override;
   void SendParameterValueFromDelegate(int paramIdx, double value, bool normalized) override {} // NOOP in VST3 processor -> param change gets there via IPlugVST3Controller::setParamNormalized
+  void SendParameterValuesFromDelegate(const int* pParamIdxs, int nParams) override {} // NOOP, as above
   void SendArbitraryMsgFromDelegate(int msgTag, int dataSize = 0, const void* pData = nullptr) override;
   
   void removeAudioInputBus(Steinberg::Vst::AudioBus* pBus)
@@ -215,6 +215,12 @@ void IPlugVST3ProcessorBase::AttachBuffers(ERoute direction, int idx, int n, Aud
     IPlugProcessor::AttachBuffers(direction, idx, n, pBus.channelBuffers64, nFrames);
 }
 
+void IPlugVST3ProcessorBase::SetInputSilenceFlags(int idx, AudioBusBuffers& bus)
+{
+  for (int c = 0; c < bus.numChannels; c++)
+    SetInputSilent(idx + c, c < 64 && ((bus.silenceFlags >> c) & 1));
+}
+
 bool IPlugVST3ProcessorBase::SetupProcessing(const ProcessSetup& setup, ProcessSetup& storedSetup)
 {
   if ((setup.symbolicSampleSize != kSample32) && (setup.symbolicSampleSize != kSample64))
@@ -224,6 +230,7 @@ bool IPlugVST3ProcessorBase::SetupProcessing(const ProcessSetup& setup, ProcessS
   
   SetSampleRate(setup.sampleRate);
   IPlugProcessor::SetBlockSize(setup.maxSamplesPerBlock);
+  mPlug.PrepareParamSmoothing(setup.maxSamplesPerBlock);
   mMidiOutputQueue.Resize(setup.maxSamplesPerBlock);
   OnReset();
     
@@ -375,15 +382,20 @@ void IPlugVST3ProcessorBase::ProcessAudio(ProcessData& data, ProcessSetup& setup
         }
         
         AttachBuffers(ERoute::kInput, 0, data.inputs[0].numChannels, data.inputs[0], data.numSamples, sampleSize);
+        SetInputSilenceFlags(0, data.inputs[0]);
         
         if(mSidechainActive)
+        {
           AttachBuffers(ERoute::kInput, mMaxNChansForMainInputBus, data.inputs[1].numChannels, data.inputs[1], data.numSamples, sampleSize);
+          SetInputSilenceFlags(mMaxNChansForMainInputBus, data.inputs[1]);
+        }
       }
       else
       {
         SetChannelConnections(ERoute::kInput, 0, MaxNChannels(ERoute::kInput), false);
         SetChannelConnections(ERoute::kInput, 0, data.inputs[0].numChannels, true);
         AttachBuffers(ERoute::kInput, 0, data.inputs[0].numChannels, data.inputs[0], data.numSamples, sampleSize);
+        SetInputSilenceFlags(0, data.inputs[0]);
       }
     }
     
@@ -408,6 +420,8 @@ void IPlugVST3ProcessorBase::ProcessAudio(ProcessData& data, ProcessSetup& setup
 #ifdef PARAMS_MUTEX
       mPlug.mParams_mutex.Enter();
 #endif
+      mPlug.ProcessParamSmoothing(GetSampleRate(), data.numSamples);
+
       if (sampleSize == kSample32)
         ProcessBuffers(0.f, data.numSamples); // single precision
       else
@@ -416,6 +430,21 @@ void IPlugVST3ProcessorBase::ProcessAudio(ProcessData& data, ProcessSetup& setup
       mPlug.mParams_mutex.Leave();
 #endif
     }
+
+    // Report silent outputs to the host
+    for (int outBus = 0, chanOffset = 0; outBus < data.numOutputs; outBus++)
+    {
+      AudioBusBuffers& bus = data.outputs[outBus];
+      bus.silenceFlags = 0;
+
+      for (int c = 0; c < bus.numChannels && c < 64; c++)
+      {
+        if (IsChannelSilent(ERoute::kOutput, chanOffset + c))
+          bus.silenceFlags |= static_cast<uint64>(1) << c;
+      }
+
+      chanOffset += bus.numChannels;
+    }
   }
 }
 
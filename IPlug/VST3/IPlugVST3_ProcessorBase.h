@@ -178,6 +178,7 @@ public:
   }
   
   void AttachBuffers(ERoute direction, int idx, int n, Steinberg::Vst::AudioBusBuffers& pBus, int nFrames, Steinberg::int32 sampleSize);
+  void SetInputSilenceFlags(int idx, Steinberg::Vst::AudioBusBuffers& bus);
   bool SetupProcessing(const Steinberg::Vst::ProcessSetup& setup, Steinberg::Vst::ProcessSetup& storedSetup);
   bool CanProcessSampleSize(Steinberg::int32 symbolicSampleSize);
   bool SetProcessing(bool state);
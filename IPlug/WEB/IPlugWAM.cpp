@@ -28,6 +28,7 @@ const char* IPlugWAM::init(uint32_t bufsize, uint32_t sr, void* pDesc)
 
   SetSampleRate(sr);
   SetBlockSize(bufsize);
+  PrepareParamSmoothing(bufsize);
 
   DBGMSG("%i %i\n", sr, bufsize);
 
@@ -67,6 +68,7 @@ void IPlugWAM::onProcess(WAM::AudioBus* pAudio, void* pData)
   AttachBuffers(ERoute::kOutput, 0, NChannelsConnected(ERoute::kOutput), pAudio->outputs, blockSize);
   
   ENTER_PARAMS_MUTEX
+  ProcessParamSmoothing(GetSampleRate(), blockSize);
   ProcessBuffers((float) 0.0f, blockSize);
   LEAVE_PARAMS_MUTEX
 }
@@ -66,6 +66,7 @@ void IPlugWasmDSP::Init(int sampleRate, int blockSize)
 
   SetSampleRate(sampleRate);
   SetBlockSize(blockSize);
+  PrepareParamSmoothing(blockSize);
 
   OnParamReset(kReset);
   OnReset();
@@ -85,6 +86,7 @@ void IPlugWasmDSP::ProcessBlock(sample** inputs, sample** outputs, int nFrames)
   // which is serialized, so the mutex primarily guards against concurrent
   // parameter changes from within ProcessBuffers itself (e.g., meta-parameters).
   ENTER_PARAMS_MUTEX
+  ProcessParamSmoothing(GetSampleRate(), nFrames);
   ProcessBuffers(0.0f, nFrames);
   LEAVE_PARAMS_MUTEX
 }
@@ -72,6 +72,7 @@ public:
   void SendControlValueFromDelegate(int ctrlTag, double normalizedValue) override;
   void SendControlMsgFromDelegate(int ctrlTag, int msgTag, int dataSize, const void* pData) override;
   void SendParameterValueFromDelegate(int paramIdx, double value, bool normalized) override;
+  void SendParameterValuesFromDelegate(const int* pParamIdxs, int nParams) override { IEditorDelegate::SendParameterValuesFromDelegate(pParamIdxs, nParams); }
   void SendArbitraryMsgFromDelegate(int msgTag, int dataSize = 0, const void* pData = nullptr) override;
   void SendMidiMsgFromDelegate(const IMidiMsg& msg) override;
 
@@ -0,0 +1,50 @@
+/*
+ ==============================================================================
+
+ This file is part of the iPlug 2 library. Copyright (C) the iPlug 2 developers.
+
+ See LICENSE.txt for  more info.
+
+ ==============================================================================
+*/
+
+// Checks that a WavetableOscillator playing a sine keeps its amplitude at every mip level, up to half of nyquist
+
+#include <cstdio>
+#include <vector>
+
+#include "WavetableOscillator.h"
+
+using namespace iplug;
+
+int main()
+{
+  const double sampleRate = 48000.;
+  const int blockSize = 64;
+  const int nBlocks = 200;
+  int nFailed = 0;
+
+  for (double freq = 50.; freq <= sampleRate / 4.; freq *= 1.25)
+  {
+    WavetableOscillator<double> osc(Wavetable::Get(Wavetable::kSine));
+    osc.SetSampleRate(sampleRate);
+    osc.SetFreqCPS(freq);
+
+    std::vector<double> block(blockSize);
+    double peak = 0.;
+
+    for (auto b = 0; b < nBlocks; b++)
+    {
+      osc.ProcessBlock(block.data(), blockSize);
+
+      for (auto s = 0; s < blockSize; s++)
+        peak = std::max(peak, std::abs(block[s]));
+    }
+
+    const bool passed = peak > 0.95 && peak < 1.05;
+    nFailed += !passed;
+    printf("%s %8.1f Hz peak %.3f\n", passed ? "ok  " : "FAIL", freq, peak);
+  }
+
+  return nFailed ? 1 : 0;
+}